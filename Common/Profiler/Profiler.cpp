@@ -1,6 +1,8 @@
 // Ultra-lightweight category profiler with history.
 
 #include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <mutex>
 #include <vector>
 #include <cstring>
@@ -9,6 +11,10 @@
 
 #include "Common/Render/DrawBuffer.h"
 
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/Log.h"
@@ -262,3 +268,225 @@ void Profiler_GetHistory(int category, int thread, float *data, int count) {
 		data[i] = history[MAX_THREADS * x + thread].time_taken[category];
 	}
 }
+
+// Events per thread per trace, older ones are kept and newer dropped when full.
+#define TRACE_EVENTS_PER_THREAD (1 << 16)
+// Event storage is allocated in chunks as it fills, so quiet threads stay small.
+#define TRACE_EVENTS_PER_CHUNK 4096
+#define TRACE_CHUNKS_PER_THREAD (TRACE_EVENTS_PER_THREAD / TRACE_EVENTS_PER_CHUNK)
+// Scopes shorter than this (like per-pixel ones) aren't useful on a timeline and would just fill the buffer.
+#define TRACE_MIN_DURATION_NS 1000
+#define TRACE_INSTANT -1
+
+struct TraceEvent {
+	const char *name;
+	int64_t start;
+	int64_t duration;
+};
+
+struct TraceThreadBuffer {
+	// Only written by the owning thread, a chunk is allocated before count points into it.
+	TraceEvent *chunks[TRACE_CHUNKS_PER_THREAD]{};
+	std::atomic<uint32_t> count{};
+	std::atomic<uint32_t> dropped{};
+	uint32_t generation = 0;
+	int tid = 0;
+	// Copied, thread names may live on the thread's stack.
+	char threadName[32]{};
+	bool owned = false;
+};
+
+static std::mutex traceBuffersLock;
+
+struct TraceThreadSlot {
+	~TraceThreadSlot() {
+		if (buffer) {
+			std::lock_guard<std::mutex> guard(traceBuffersLock);
+			buffer->owned = false;
+		}
+	}
+
+	TraceThreadBuffer *buffer = nullptr;
+	// Set by SetCurrentThreadName(), copied into the buffer each trace.
+	char threadName[32]{};
+};
+
+std::atomic<bool> g_profilerTracing;
+static std::atomic<uint32_t> traceGeneration;
+static int64_t traceStartTime;
+// Buffers are never freed, threads that exit hand theirs back for reuse by a later trace.
+static std::vector<TraceThreadBuffer *> traceBuffers;
+#if MAX_THREADS > 1
+static thread_local TraceThreadSlot traceThreadSlot;
+#else
+// Without thread_local, all threads would share one buffer, so Profiler_SetTracing() refuses.
+static TraceThreadSlot traceThreadSlot;
+#endif
+
+int64_t internal_trace_now() {
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static TraceThreadBuffer *internal_trace_find_buffer() {
+	uint32_t generation = traceGeneration.load(std::memory_order_acquire);
+	TraceThreadBuffer *buffer = traceThreadSlot.buffer;
+	if (!buffer) {
+		std::lock_guard<std::mutex> guard(traceBuffersLock);
+		for (TraceThreadBuffer *b : traceBuffers) {
+			// Only take over buffers with no events we still want.
+			if (!b->owned && b->generation != generation) {
+				buffer = b;
+				break;
+			}
+		}
+		if (!buffer) {
+			buffer = new TraceThreadBuffer();
+			buffer->tid = (int)traceBuffers.size() + 1;
+			traceBuffers.push_back(buffer);
+		}
+		buffer->owned = true;
+		buffer->generation = generation - 1;
+		traceThreadSlot.buffer = buffer;
+	}
+
+	if (buffer->generation != generation) {
+		buffer->count.store(0, std::memory_order_release);
+		buffer->dropped = 0;
+		buffer->generation = generation;
+		std::lock_guard<std::mutex> guard(traceBuffersLock);
+		truncate_cpy(buffer->threadName, traceThreadSlot.threadName);
+	}
+	return buffer;
+}
+
+void Profiler_SetThreadName(const char *name) {
+	truncate_cpy(traceThreadSlot.threadName, name ? name : "");
+	// If this thread is already in the current trace, rename it there too.
+	TraceThreadBuffer *buffer = traceThreadSlot.buffer;
+	if (buffer && buffer->generation == traceGeneration.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> guard(traceBuffersLock);
+		truncate_cpy(buffer->threadName, traceThreadSlot.threadName);
+	}
+}
+
+static void internal_trace_push(const char *name, int64_t start, int64_t duration) {
+	TraceThreadBuffer *buffer = internal_trace_find_buffer();
+	uint32_t count = buffer->count.load(std::memory_order_relaxed);
+	if (count >= TRACE_EVENTS_PER_THREAD) {
+		buffer->dropped++;
+		return;
+	}
+	TraceEvent *&chunk = buffer->chunks[count / TRACE_EVENTS_PER_CHUNK];
+	if (!chunk)
+		chunk = new TraceEvent[TRACE_EVENTS_PER_CHUNK];
+	chunk[count % TRACE_EVENTS_PER_CHUNK] = TraceEvent{ name, start, duration };
+	buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void internal_trace_event(const char *name, int64_t start) {
+	int64_t duration = internal_trace_now() - start;
+	if (duration >= TRACE_MIN_DURATION_NS)
+		internal_trace_push(name, start, duration);
+}
+
+void internal_trace_instant(const char *name) {
+	internal_trace_push(name, internal_trace_now(), TRACE_INSTANT);
+}
+
+void Profiler_SetTracing(bool enable) {
+	if (enable == g_profilerTracing)
+		return;
+#if MAX_THREADS == 1
+	if (enable) {
+		WARN_LOG(SYSTEM, "Profiler: tracing needs thread_local, not supported on this platform");
+		return;
+	}
+#endif
+	if (enable) {
+		// Buffers notice the new generation and reset themselves on next use.
+		traceStartTime = internal_trace_now();
+		traceGeneration++;
+		INFO_LOG(SYSTEM, "Profiler: started tracing");
+	} else {
+		INFO_LOG(SYSTEM, "Profiler: stopped tracing");
+	}
+	g_profilerTracing = enable;
+}
+
+static std::string TraceMicros(int64_t ns) {
+	// Chrome traces are in microseconds, keep the nanoseconds as a fraction.
+	return StringFromFormat("%" PRId64 ".%03d", ns / 1000, (int)(ns % 1000));
+}
+
+bool Profiler_SaveTrace(const Path &filename) {
+	Profiler_SetTracing(false);
+
+	FILE *fp = File::OpenCFile(filename, "wb");
+	if (!fp) {
+		ERROR_LOG(SYSTEM, "Profiler: unable to write trace to %s", filename.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(traceBuffersLock);
+	uint32_t generation = traceGeneration;
+
+	json::JsonWriter writer;
+	writer.begin();
+	writer.writeString("displayTimeUnit", "ms");
+	writer.pushArray("traceEvents");
+
+	size_t total = 0;
+	uint32_t dropped = 0;
+	for (TraceThreadBuffer *buffer : traceBuffers) {
+		if (buffer->generation != generation)
+			continue;
+
+		writer.pushDict();
+		writer.writeString("name", "thread_name");
+		writer.writeString("ph", "M");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", buffer->tid);
+		writer.pushDict("args");
+		writer.writeString("name", buffer->threadName[0] ? std::string(buffer->threadName) : StringFromFormat("Thread %d", buffer->tid));
+		writer.pop();
+		writer.pop();
+
+		uint32_t count = buffer->count.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; ++i) {
+			const TraceEvent &ev = buffer->chunks[i / TRACE_EVENTS_PER_CHUNK][i % TRACE_EVENTS_PER_CHUNK];
+			writer.pushDict();
+			writer.writeString("name", ev.name);
+			if (ev.duration == TRACE_INSTANT) {
+				writer.writeString("ph", "i");
+				writer.writeString("s", "p");
+			} else {
+				writer.writeString("ph", "X");
+				writer.writeRaw("dur", TraceMicros(ev.duration));
+			}
+			writer.writeRaw("ts", TraceMicros(ev.start - traceStartTime));
+			writer.writeInt("pid", 1);
+			writer.writeInt("tid", buffer->tid);
+			writer.pop();
+
+			// Don't build up the whole thing in memory.
+			if ((i & 1023) == 1023) {
+				std::string chunk = writer.flush();
+				fwrite(chunk.data(), 1, chunk.size(), fp);
+			}
+		}
+		total += count;
+		dropped += buffer->dropped;
+	}
+
+	writer.pop();
+	writer.end();
+	std::string chunk = writer.flush();
+	bool success = fwrite(chunk.data(), 1, chunk.size(), fp) == chunk.size();
+	fclose(fp);
+
+	if (dropped != 0)
+		WARN_LOG(SYSTEM, "Profiler: %d trace events dropped, buffers were full", dropped);
+	INFO_LOG(SYSTEM, "Profiler: wrote %d trace events to %s", (int)total, filename.c_str());
+	return success;
+}
@@ -1,9 +1,52 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
+class Path;
+
 // #define USE_PROFILER
 
+// Timeline tracing is always compiled in, but only records while enabled at runtime.
+// Each thread appends to its own buffer, and the result can be saved as a Chrome trace
+// (load in chrome://tracing or ui.perfetto.dev.)
+extern std::atomic<bool> g_profilerTracing;
+
+void Profiler_SetTracing(bool enable);
+inline bool Profiler_IsTracing() {
+	return g_profilerTracing.load(std::memory_order_relaxed);
+}
+// Returns false if the file could not be written.  Stops tracing if active.
+bool Profiler_SaveTrace(const Path &filename);
+// Called by SetCurrentThreadName(), names the calling thread in traces.
+void Profiler_SetThreadName(const char *name);
+
+int64_t internal_trace_now();
+void internal_trace_event(const char *name, int64_t start);
+void internal_trace_instant(const char *name);
+
+class TraceThis {
+public:
+	TraceThis(const char *name) {
+		if (Profiler_IsTracing()) {
+			name_ = name;
+			start_ = internal_trace_now();
+		}
+	}
+	~TraceThis() {
+		if (name_)
+			internal_trace_event(name_, start_);
+	}
+private:
+	const char *name_ = nullptr;
+	int64_t start_ = 0;
+};
+
+inline void internal_trace_frame() {
+	if (Profiler_IsTracing())
+		internal_trace_instant("frame");
+}
+
 #ifdef USE_PROFILER
 
 class DrawBuffer;
@@ -36,13 +79,13 @@ class ProfileThis {
 };
 
 #define PROFILE_INIT() internal_profiler_init();
-#define PROFILE_THIS_SCOPE(cat) ProfileThis _profile_scoped(cat);
-#define PROFILE_END_FRAME() internal_profiler_end_frame();
+#define PROFILE_THIS_SCOPE(cat) ProfileThis _profile_scoped(cat); TraceThis _trace_scoped(cat);
+#define PROFILE_END_FRAME() internal_profiler_end_frame(); internal_trace_frame();
 
 #else
 
 #define PROFILE_INIT()
-#define PROFILE_THIS_SCOPE(cat)
-#define PROFILE_END_FRAME()
+#define PROFILE_THIS_SCOPE(cat) TraceThis _trace_scoped(cat);
+#define PROFILE_END_FRAME() internal_trace_frame();
 
 #endif
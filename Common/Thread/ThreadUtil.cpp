@@ -20,6 +20,7 @@
 #include <cstdint>
 
 #include "Common/Log.h"
+#include "Common/Profiler/Profiler.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Encoding/Utf8.h"
 
@@ -120,6 +121,7 @@ void SetCurrentThreadName(const char* threadName) {
 #ifdef TLS_SUPPORTED
 	curThreadName = threadName;
 #endif
+	Profiler_SetThreadName(threadName);
 }
 
 #if PPSSPP_PLATFORM(WINDOWS)
@@ -190,6 +192,14 @@ void AssertCurrentThreadName(const char *threadName) {
 #endif
 }
 
+const char *GetCurrentThreadName() {
+#ifdef TLS_SUPPORTED
+	return curThreadName;
+#else
+	return nullptr;
+#endif
+}
+
 int GetCurrentThreadIdForDebug() {
 #if __LIBRETRO__
 	// Not sure why gettid() would not be available, but it isn't.
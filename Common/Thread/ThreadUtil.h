@@ -6,6 +6,8 @@
 // for AssertCurrentThreadName to work.
 void SetCurrentThreadName(const char *threadName);
 void AssertCurrentThreadName(const char *threadName);
+// Returns the name set by SetCurrentThreadName, or nullptr if none (or unsupported.)
+const char *GetCurrentThreadName();
 
 // Just gets a cheap thread identifier so that you can see different threads in debug output,
 // exactly what it is is badly specified and not useful for anything.
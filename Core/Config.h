@@ -118,6 +118,7 @@ struct Config {
 	uint32_t uJitDisableFlags;
 
 	bool bSeparateSASThread;
+	int iVideoDecodeAhead;  // Number of movie frames to decode on a separate thread, 0 = off.
 	int iIOTimingMethod;
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
@@ -131,6 +132,7 @@ struct Config {
 	bool bRemoteDebuggerOnStartup;
 	bool bMemStickInserted;
 	int iMemStickSizeGB;
+	bool bMemStickWriteBack;
 	bool bLoadPlugins;
 
 	int iScreenRotation;  // The rotation angle of the PPSSPP UI. Only supported on Android and possibly other mobile platforms.
@@ -156,6 +158,7 @@ struct Config {
 
 	bool bSoftwareRendering;
 	bool bSoftwareRenderingJit;
+	bool bSoftwareRenderingHierarchical;
 	bool bHardwareTransform; // only used in the GLES backend
 	bool bSoftwareSkinning;  // may speed up some games
 	bool bVendorBugChecksEnabled;
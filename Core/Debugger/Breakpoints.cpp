@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdio>
 #include <atomic>
 #include <mutex>
@@ -40,6 +41,28 @@ static std::mutex memCheckMutex_;
 std::vector<MemCheck> CBreakPoints::memChecks_;
 std::vector<MemCheck *> CBreakPoints::cleanupMemChecks_;
 
+// Sorted addresses of breakPoints_, so range checks at jit time are a binary search.
+static std::vector<u32> breakPointAddrs_;
+
+// One bit per page (of the uncached address) that any memcheck touches.
+// Only written under memCheckMutex_, but read without it so "no memcheck here" is cheap.
+// Words are updated one at a time, so pages of checks that stay never read as clear.
+static const int MEMCHECK_PAGE_SHIFT = 12;
+static const size_t MEMCHECK_PAGE_WORDS = (1ULL << (32 - MEMCHECK_PAGE_SHIFT)) / 32;
+static std::atomic<u32> memCheckPages_[MEMCHECK_PAGE_WORDS];
+
+struct MemCheckInterval {
+	u32 start;
+	u32 end;
+	// Highest end of this and all previous intervals, so lookups know when to stop.
+	u32 maxEnd;
+	// Index into memChecks_, the lowest matching one wins.
+	u32 index;
+	bool exact;
+};
+// Sorted by start, rebuilt under memCheckMutex_ whenever memChecks_ changes.
+static std::vector<MemCheckInterval> memCheckIntervals_;
+
 void MemCheck::Log(u32 addr, bool write, int size, u32 pc, const char *reason) {
 	if (result & BREAK_ACTION_LOG) {
 		const char *type = write ? "Write" : "Read";
@@ -157,6 +180,84 @@ size_t CBreakPoints::FindMemCheck(u32 start, u32 end)
 	return INVALID_MEMCHECK;
 }
 
+static inline u32 NotCached(u32 val)
+{
+	// Remove the cached part of the address.
+	return val & ~0x40000000;
+}
+
+// Note: must lock breakPointsMutex_ while calling this.
+void CBreakPoints::UpdateBreakPointIndex()
+{
+	breakPointAddrs_.clear();
+	breakPointAddrs_.reserve(breakPoints_.size());
+	for (const auto &bp : breakPoints_)
+		breakPointAddrs_.push_back(bp.addr);
+	std::sort(breakPointAddrs_.begin(), breakPointAddrs_.end());
+}
+
+// Note: must lock memCheckMutex_ while calling this.
+void CBreakPoints::UpdateMemCheckIndex()
+{
+	// Build the new bitmap on the side, the CPU thread may be reading the current one.
+	std::vector<u32> pages(MEMCHECK_PAGE_WORDS);
+	memCheckIntervals_.clear();
+	memCheckIntervals_.reserve(memChecks_.size());
+
+	auto markPages = [&pages](u32 first, u32 last) {
+		for (u64 page = first >> MEMCHECK_PAGE_SHIFT; page <= (last >> MEMCHECK_PAGE_SHIFT); ++page)
+			pages[page >> 5] |= 1 << (page & 31);
+	};
+
+	for (size_t i = 0; i < memChecks_.size(); ++i) {
+		const MemCheck &check = memChecks_[i];
+		MemCheckInterval interval;
+		interval.start = NotCached(check.start);
+		interval.index = (u32)i;
+		interval.exact = check.end == 0;
+		if (interval.exact) {
+			interval.end = interval.start + 1;
+			markPages(interval.start, interval.start);
+		} else {
+			interval.end = NotCached(check.end);
+			// A backwards range can still match an access spanning it, so mark it all.
+			if (interval.end > interval.start)
+				markPages(interval.start, interval.end - 1);
+			else
+				markPages(interval.end, interval.start);
+		}
+		memCheckIntervals_.push_back(interval);
+	}
+
+	for (size_t i = 0; i < MEMCHECK_PAGE_WORDS; ++i) {
+		if (memCheckPages_[i].load(std::memory_order_relaxed) != pages[i])
+			memCheckPages_[i].store(pages[i], std::memory_order_relaxed);
+	}
+
+	std::sort(memCheckIntervals_.begin(), memCheckIntervals_.end(), [](const MemCheckInterval &a, const MemCheckInterval &b) {
+		return a.start < b.start;
+	});
+	u32 maxEnd = 0;
+	for (auto &interval : memCheckIntervals_) {
+		maxEnd = std::max(maxEnd, std::max(interval.end, interval.start + 1));
+		interval.maxEnd = maxEnd;
+	}
+}
+
+bool CBreakPoints::MemCheckPagesMaybe(u32 address, u32 size)
+{
+	u32 first = NotCached(address) >> MEMCHECK_PAGE_SHIFT;
+	u32 last = NotCached(address + (size == 0 ? 0 : size - 1)) >> MEMCHECK_PAGE_SHIFT;
+	// Wrapped around or huge, just do the full check.
+	if (last < first || last - first > 0x1000)
+		return true;
+	for (u32 page = first; page <= last; ++page) {
+		if (memCheckPages_[page >> 5].load(std::memory_order_relaxed) & (1 << (page & 31)))
+			return true;
+	}
+	return false;
+}
+
 bool CBreakPoints::IsAddressBreakPoint(u32 addr)
 {
 	std::lock_guard<std::mutex> guard(breakPointsMutex_);
@@ -185,13 +286,8 @@ bool CBreakPoints::RangeContainsBreakPoint(u32 addr, u32 size)
 {
 	std::lock_guard<std::mutex> guard(breakPointsMutex_);
 	const u32 end = addr + size;
-	for (const auto &bp : breakPoints_)
-	{
-		if (bp.addr >= addr && bp.addr < end)
-			return true;
-	}
-
-	return false;
+	auto it = std::lower_bound(breakPointAddrs_.begin(), breakPointAddrs_.end(), addr);
+	return it != breakPointAddrs_.end() && *it < end;
 }
 
 void CBreakPoints::AddBreakPoint(u32 addr, bool temp)
@@ -206,6 +302,7 @@ void CBreakPoints::AddBreakPoint(u32 addr, bool temp)
 		pt.addr = addr;
 
 		breakPoints_.push_back(pt);
+		UpdateBreakPointIndex();
 		guard.unlock();
 		Update(addr);
 	}
@@ -231,6 +328,7 @@ void CBreakPoints::RemoveBreakPoint(u32 addr)
 		if (bp != INVALID_BREAKPOINT)
 			breakPoints_.erase(breakPoints_.begin() + bp);
 
+		UpdateBreakPointIndex();
 		guard.unlock();
 		Update(addr);
 	}
@@ -270,6 +368,7 @@ void CBreakPoints::ClearAllBreakPoints()
 	if (!breakPoints_.empty())
 	{
 		breakPoints_.clear();
+		UpdateBreakPointIndex();
 		guard.unlock();
 		Update();
 	}
@@ -291,6 +390,8 @@ void CBreakPoints::ClearTemporaryBreakPoints()
 		}
 	}
 
+	if (update)
+		UpdateBreakPointIndex();
 	guard.unlock();
 	if (update)
 		Update();
@@ -389,6 +490,7 @@ void CBreakPoints::AddMemCheck(u32 start, u32 end, MemCheckCondition cond, Break
 		check.result = result;
 
 		memChecks_.push_back(check);
+		UpdateMemCheckIndex();
 		anyMemChecks_ = true;
 		guard.unlock();
 		Update();
@@ -413,6 +515,7 @@ void CBreakPoints::RemoveMemCheck(u32 start, u32 end)
 	if (mc != INVALID_MEMCHECK)
 	{
 		memChecks_.erase(memChecks_.begin() + mc);
+		UpdateMemCheckIndex();
 		anyMemChecks_ = !memChecks_.empty();
 		guard.unlock();
 		Update();
@@ -441,6 +544,8 @@ void CBreakPoints::ClearAllMemChecks()
 	if (!memChecks_.empty())
 	{
 		memChecks_.clear();
+		UpdateMemCheckIndex();
+		anyMemChecks_ = false;
 		guard.unlock();
 		Update();
 	}
@@ -466,13 +571,9 @@ bool CBreakPoints::GetMemCheck(u32 start, u32 end, MemCheck *check) {
 	return false;
 }
 
-static inline u32 NotCached(u32 val)
-{
-	// Remove the cached part of the address.
-	return val & ~0x40000000;
-}
-
 bool CBreakPoints::GetMemCheckInRange(u32 address, int size, MemCheck *check) {
+	if (!anyMemChecks_ || !MemCheckPagesMaybe(address, size))
+		return false;
 	std::lock_guard<std::mutex> guard(memCheckMutex_);
 	auto result = GetMemCheckLocked(address, size);
 	if (result)
@@ -481,29 +582,34 @@ bool CBreakPoints::GetMemCheckInRange(u32 address, int size, MemCheck *check) {
 }
 
 MemCheck *CBreakPoints::GetMemCheckLocked(u32 address, int size) {
-	std::vector<MemCheck>::iterator iter;
-	for (iter = memChecks_.begin(); iter != memChecks_.end(); ++iter)
-	{
-		MemCheck &check = *iter;
-		if (check.end != 0)
-		{
-			if (NotCached(address + size) > NotCached(check.start) && NotCached(address) < NotCached(check.end))
-				return &check;
-		}
+	const u32 lo = NotCached(address);
+	const u32 hi = NotCached(address + size);
+
+	// Anything starting at or after the end of the access can't match (exact ones only match lo.)
+	auto it = std::upper_bound(memCheckIntervals_.begin(), memCheckIntervals_.end(), std::max(hi, lo + 1) - 1, [](u32 addr, const MemCheckInterval &interval) {
+		return addr < interval.start;
+	});
+
+	u32 found = (u32)-1;
+	while (it != memCheckIntervals_.begin()) {
+		--it;
+		if (it->maxEnd <= lo)
+			break;
+		bool match;
+		if (it->exact)
+			match = it->start == lo;
 		else
-		{
-			if (NotCached(check.start) == NotCached(address))
-				return &check;
-		}
+			match = hi > it->start && lo < it->end;
+		if (match && it->index < found)
+			found = it->index;
 	}
 
-	//none found
-	return 0;
+	return found == (u32)-1 ? nullptr : &memChecks_[found];
 }
 
 BreakAction CBreakPoints::ExecMemCheck(u32 address, bool write, int size, u32 pc, const char *reason)
 {
-	if (!anyMemChecks_)
+	if (!anyMemChecks_ || !MemCheckPagesMaybe(address, size))
 		return BREAK_ACTION_IGNORE;
 	std::unique_lock<std::mutex> guard(memCheckMutex_);
 	auto check = GetMemCheckLocked(address, size);
@@ -593,13 +699,14 @@ u32 CBreakPoints::CheckSkipFirst()
 
 const std::vector<MemCheck> CBreakPoints::GetMemCheckRanges(bool write) {
 	std::lock_guard<std::mutex> guard(memCheckMutex_);
-	std::vector<MemCheck> ranges = memChecks_;
+	std::vector<MemCheck> ranges;
 	for (const auto &check : memChecks_) {
 		if (!(check.cond & MEMCHECK_READ) && !write)
 			continue;
 		if (!(check.cond & MEMCHECK_WRITE) && write)
 			continue;
 
+		ranges.push_back(check);
 		MemCheck copy = check;
 		// Toggle the cached part of the address.
 		copy.start ^= 0x40000000;
@@ -161,8 +161,10 @@ class CBreakPoints
 	static void SetSkipFirst(u32 pc);
 	static u32 CheckSkipFirst();
 
-	// Includes uncached addresses.
+	// Includes uncached addresses, and only checks matching the access type.
 	static const std::vector<MemCheck> GetMemCheckRanges(bool write);
+	// Fast conservative check, false means no memcheck could match.  Doesn't lock.
+	static bool MemCheckPagesMaybe(u32 address, u32 size);
 
 	static const std::vector<MemCheck> GetMemChecks();
 	static const std::vector<BreakPoint> GetBreakpoints();
@@ -179,6 +181,8 @@ class CBreakPoints
 	// Finds exactly, not using a range check.
 	static size_t FindMemCheck(u32 start, u32 end);
 	static MemCheck *GetMemCheckLocked(u32 address, int size);
+	static void UpdateBreakPointIndex();
+	static void UpdateMemCheckIndex();
 
 	static std::vector<BreakPoint> breakPoints_;
 	static u32 breakSkipFirstAt_;
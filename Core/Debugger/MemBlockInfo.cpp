@@ -18,8 +18,12 @@
 #include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <deque>
 #include <mutex>
+#include <string_view>
+#include <unordered_map>
 
+#include "ppsspp_config.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -30,13 +34,64 @@
 #include "Core/MIPS/MIPS.h"
 #include "Common/StringUtils.h"
 
+// Tags are interned so slabs stay small and comparing them is just an integer compare.
+// Only accessed with memInfoMutex held.
+class MemTagTable {
+public:
+	MemTagTable() {
+		Reset();
+	}
+
+	uint32_t Intern(const char *tag) {
+		std::string_view key(tag);
+		auto it = index_.find(key);
+		if (it != index_.end())
+			return it->second;
+
+		uint32_t id = (uint32_t)strings_.size();
+		strings_.emplace_back(key);
+		// deque never moves existing elements, so the view stays valid.
+		index_[strings_.back()] = id;
+		return id;
+	}
+
+	const char *Get(uint32_t id) const {
+		return strings_[id].c_str();
+	}
+
+	size_t Size() const {
+		return strings_.size();
+	}
+
+	void Swap(MemTagTable &other) {
+		// Neither container moves its elements, so the views stay valid.
+		strings_.swap(other.strings_);
+		index_.swap(other.index_);
+	}
+
+	void Reset() {
+		index_.clear();
+		strings_.clear();
+		// Index 0 is always the empty tag.
+		Intern("");
+	}
+
+private:
+	std::deque<std::string> strings_;
+	std::unordered_map<std::string_view, uint32_t> index_;
+};
+
 class MemSlabMap {
 public:
 	MemSlabMap();
 	~MemSlabMap();
 
-	bool Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc, bool allocated, const char *tag);
+	static constexpr uint32_t KEEP_TAG = 0xFFFFFFFF;
+
+	bool Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc, bool allocated, uint32_t tag);
 	bool Find(MemBlockFlags flags, uint32_t addr, uint32_t size, std::vector<MemBlockInfo> &results);
+	// Moves each slab's tag from one table to the other.
+	void RemapTags(const MemTagTable &from, MemTagTable &to);
 	void Reset();
 	void DoState(PointerWrap &p);
 
@@ -46,10 +101,10 @@ class MemSlabMap {
 		uint32_t end = 0;
 		uint64_t ticks = 0;
 		uint32_t pc = 0;
-		bool allocated = false;
-		char tag[128]{};
+		uint32_t tag = 0;
 		Slab *prev = nullptr;
 		Slab *next = nullptr;
+		bool allocated = false;
 
 		void DoState(PointerWrap &p);
 	};
@@ -57,6 +112,7 @@ class MemSlabMap {
 	static constexpr uint32_t MAX_SIZE = 0x40000000;
 	static constexpr uint32_t SLICES = 16384;
 	static constexpr uint32_t SLICE_SIZE = MAX_SIZE / SLICES;
+	static constexpr size_t SLABS_PER_CHUNK = 1024;
 
 	Slab *FindSlab(uint32_t addr);
 	void Clear();
@@ -66,31 +122,80 @@ class MemSlabMap {
 	static inline bool Same(const Slab *a, const Slab *b);
 	void Merge(Slab *a, Slab *b);
 	void FillHeads(Slab *slab);
+	Slab *AllocSlab();
+	void FreeSlab(Slab *slab);
 
 	Slab *first_ = nullptr;
 	Slab *lastFind_ = nullptr;
 	std::vector<Slab *> heads_;
+	// Slabs are carved out of chunks to keep neighbors close in memory and avoid heap churn.
+	std::vector<Slab *> chunks_;
+	Slab *freeSlabs_ = nullptr;
 };
 
 struct PendingNotifyMem {
 	MemBlockFlags flags;
 	uint32_t start;
 	uint32_t size;
-	uint64_t ticks;
 	uint32_t pc;
+	uint64_t ticks;
+	// Orders notifications from different threads when flushing.
+	uint64_t seq;
 	char tag[128];
 };
 
-static constexpr size_t MAX_PENDING_NOTIFIES = 512;
+// Each thread that notifies gets its own single producer, single consumer ring.
+// The owning thread appends without locking, and flushes drain under memInfoMutex.
+struct PendingNotifyBuffer {
+	PendingNotifyMem entries[512];
+	std::atomic<uint32_t> head{};
+	std::atomic<uint32_t> tail{};
+	std::atomic<bool> inUse{};
+};
+
+static constexpr size_t MAX_PENDING_NOTIFIES = ARRAY_SIZE(PendingNotifyBuffer::entries);
+static constexpr int MAX_NOTIFY_BUFFERS = 64;
+// Tags are only dropped when the table gets this big, by keeping just the ones slabs still use.
+static constexpr size_t MIN_TAGS_COMPACT = 16384;
+
+#if PPSSPP_PLATFORM(IOS) && defined(__IPHONE_OS_VERSION_MIN_REQUIRED) && __IPHONE_OS_VERSION_MIN_REQUIRED < __IPHONE_9_0
+// iOS did not support C++ thread_local before iOS 9, so every notification is applied under the lock.
+#define MEMINFO_THREAD_BUFFERS 0
+#else
+#define MEMINFO_THREAD_BUFFERS 1
+#endif
+
+static MemTagTable memTags;
 static MemSlabMap allocMap;
 static MemSlabMap suballocMap;
 static MemSlabMap writeMap;
 static MemSlabMap textureMap;
-static std::vector<PendingNotifyMem> pendingNotifies;
+static PendingNotifyBuffer *notifyBuffers[MAX_NOTIFY_BUFFERS];
+static std::atomic<int> notifyBufferCount;
+static std::atomic<uint64_t> pendingNotifySeq;
+static std::vector<PendingNotifyMem> flushScratch;
 static std::atomic<uint32_t> pendingNotifyMinAddr;
 static std::atomic<uint32_t> pendingNotifyMaxAddr;
-static std::mutex pendingMutex;
+static std::mutex memInfoMutex;
 static int detailedOverride;
+static size_t memTagsCompactAt = MIN_TAGS_COMPACT;
+
+static void FlushPendingMemInfoLocked();
+static void ReleaseNotifyBuffer(PendingNotifyBuffer *buffer);
+
+struct PendingNotifyThreadSlot {
+	~PendingNotifyThreadSlot() {
+		if (buffer)
+			ReleaseNotifyBuffer(buffer);
+	}
+
+	PendingNotifyBuffer *buffer = nullptr;
+	bool exhausted = false;
+};
+
+#if MEMINFO_THREAD_BUFFERS
+static thread_local PendingNotifyThreadSlot notifyThreadSlot;
+#endif
 
 MemSlabMap::MemSlabMap() {
 	Reset();
@@ -100,7 +205,7 @@ MemSlabMap::~MemSlabMap() {
 	Clear();
 }
 
-bool MemSlabMap::Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc, bool allocated, const char *tag) {
+bool MemSlabMap::Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc, bool allocated, uint32_t tag) {
 	uint32_t end = addr + size;
 	Slab *slab = FindSlab(addr);
 	Slab *firstMatch = nullptr;
@@ -117,8 +222,8 @@ bool MemSlabMap::Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc,
 			slab->ticks = ticks;
 			slab->pc = pc;
 		}
-		if (tag)
-			truncate_cpy(slab->tag, tag);
+		if (tag != KEEP_TAG)
+			slab->tag = tag;
 
 		// Move on to the next one.
 		if (firstMatch == nullptr)
@@ -139,8 +244,8 @@ bool MemSlabMap::Find(MemBlockFlags flags, uint32_t addr, uint32_t size, std::ve
 	Slab *slab = FindSlab(addr);
 	bool found = false;
 	while (slab != nullptr && slab->start < end) {
-		if (slab->pc != 0 || strlen(slab->tag)) {
-			results.push_back({ flags, slab->start, slab->end - slab->start, slab->ticks, slab->pc, slab->tag, slab->allocated });
+		if (slab->pc != 0 || slab->tag != 0) {
+			results.push_back({ flags, slab->start, slab->end - slab->start, slab->ticks, slab->pc, memTags.Get(slab->tag), slab->allocated });
 			found = true;
 		}
 		slab = slab->next;
@@ -148,10 +253,15 @@ bool MemSlabMap::Find(MemBlockFlags flags, uint32_t addr, uint32_t size, std::ve
 	return found;
 }
 
+void MemSlabMap::RemapTags(const MemTagTable &from, MemTagTable &to) {
+	for (Slab *slab = first_; slab != nullptr; slab = slab->next)
+		slab->tag = to.Intern(from.Get(slab->tag));
+}
+
 void MemSlabMap::Reset() {
 	Clear();
 
-	first_ = new Slab();
+	first_ = AllocSlab();
 	first_->end = MAX_SIZE;
 	lastFind_ = first_;
 
@@ -170,7 +280,7 @@ void MemSlabMap::DoState(PointerWrap &p) {
 		Slab *old = first_;
 		Do(p, count);
 
-		first_ = new Slab();
+		first_ = AllocSlab();
 		first_->DoState(p);
 		lastFind_ = first_;
 		--count;
@@ -179,7 +289,7 @@ void MemSlabMap::DoState(PointerWrap &p) {
 
 		Slab *slab = first_;
 		for (int i = 0; i < count; ++i) {
-			slab->next = new Slab();
+			slab->next = AllocSlab();
 			slab->next->DoState(p);
 
 			slab->next->prev = slab;
@@ -188,10 +298,10 @@ void MemSlabMap::DoState(PointerWrap &p) {
 			FillHeads(slab);
 		}
 
-		// Now that it's entirely disconnected, delete the old slabs.
+		// Now that it's entirely disconnected, free the old slabs.
 		while (old != nullptr) {
 			Slab *next = old->next;
-			delete old;
+			FreeSlab(old);
 			old = next;
 		}
 	} else {
@@ -220,35 +330,74 @@ void MemSlabMap::Slab::DoState(PointerWrap &p) {
 	Do(p, ticks);
 	Do(p, pc);
 	Do(p, allocated);
+
+	// The tag is still saved as a string, so states stay compatible.
+	char fullTag[128]{};
+	if (p.mode != p.MODE_READ)
+		truncate_cpy(fullTag, memTags.Get(tag));
 	if (s >= 3) {
-		Do(p, tag);
+		Do(p, fullTag);
 	} else if (s >= 2) {
 		char shortTag[32];
 		Do(p, shortTag);
-		memcpy(tag, shortTag, sizeof(shortTag));
+		memcpy(fullTag, shortTag, sizeof(shortTag));
 	} else {
 		std::string stringTag;
 		Do(p, stringTag);
-		truncate_cpy(tag, stringTag.c_str());
+		truncate_cpy(fullTag, stringTag.c_str());
+	}
+	if (p.mode == p.MODE_READ) {
+		fullTag[sizeof(fullTag) - 1] = 0;
+		tag = memTags.Intern(fullTag);
 	}
 }
 
 void MemSlabMap::Clear() {
-	Slab *s = first_;
-	while (s != nullptr) {
-		Slab *next = s->next;
-		delete s;
-		s = next;
-	}
+	for (Slab *chunk : chunks_)
+		delete [] chunk;
+	chunks_.clear();
+	freeSlabs_ = nullptr;
 	first_ = nullptr;
 	lastFind_ = nullptr;
 	heads_.clear();
 }
 
+MemSlabMap::Slab *MemSlabMap::AllocSlab() {
+	if (!freeSlabs_) {
+		Slab *chunk = new Slab[SLABS_PER_CHUNK];
+		chunks_.push_back(chunk);
+		for (size_t i = 0; i < SLABS_PER_CHUNK; ++i) {
+			chunk[i].next = freeSlabs_;
+			freeSlabs_ = &chunk[i];
+		}
+	}
+
+	Slab *slab = freeSlabs_;
+	freeSlabs_ = slab->next;
+	*slab = Slab();
+	return slab;
+}
+
+void MemSlabMap::FreeSlab(Slab *slab) {
+	slab->prev = nullptr;
+	slab->next = freeSlabs_;
+	freeSlabs_ = slab;
+}
+
 MemSlabMap::Slab *MemSlabMap::FindSlab(uint32_t addr) {
+	// We often move forward, so check the last find and its neighbor first.
+	if (lastFind_->start <= addr) {
+		if (lastFind_->end > addr)
+			return lastFind_;
+		Slab *next = lastFind_->next;
+		if (next && next->start <= addr && next->end > addr) {
+			lastFind_ = next;
+			return next;
+		}
+	}
+
 	// Jump ahead using our index.
 	Slab *slab = heads_[addr / SLICE_SIZE];
-	// We often move forward, so check the last find.
 	if (lastFind_->start > slab->start && lastFind_->start <= addr)
 		slab = lastFind_;
 
@@ -263,13 +412,13 @@ MemSlabMap::Slab *MemSlabMap::FindSlab(uint32_t addr) {
 }
 
 MemSlabMap::Slab *MemSlabMap::Split(Slab *slab, uint32_t size) {
-	Slab *next = new Slab();
+	Slab *next = AllocSlab();
 	next->start = slab->start + size;
 	next->end = slab->end;
 	next->ticks = slab->ticks;
 	next->pc = slab->pc;
 	next->allocated = slab->allocated;
-	truncate_cpy(next->tag, slab->tag);
+	next->tag = slab->tag;
 	next->prev = slab;
 	next->next = slab->next;
 
@@ -285,13 +434,7 @@ MemSlabMap::Slab *MemSlabMap::Split(Slab *slab, uint32_t size) {
 }
 
 bool MemSlabMap::Same(const Slab *a, const Slab *b) {
-	if (a->allocated != b->allocated)
-		return false;
-	if (a->pc != b->pc)
-		return false;
-	if (strcmp(a->tag, b->tag))
-		return false;
-	return true;
+	return a->allocated == b->allocated && a->pc == b->pc && a->tag == b->tag;
 }
 
 void MemSlabMap::MergeAdjacent(Slab *slab) {
@@ -332,7 +475,7 @@ void MemSlabMap::Merge(Slab *a, Slab *b) {
 	}
 	if (lastFind_ == b)
 		lastFind_ = a;
-	delete b;
+	FreeSlab(b);
 }
 
 void MemSlabMap::FillHeads(Slab *slab) {
@@ -353,32 +496,164 @@ void MemSlabMap::FillHeads(Slab *slab) {
 	}
 }
 
-void FlushPendingMemInfo() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
-	for (auto info : pendingNotifies) {
-		if (info.flags & MemBlockFlags::ALLOC) {
-			allocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		} else if (info.flags & MemBlockFlags::FREE) {
-			// Maintain the previous allocation tag for debugging.
-			allocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-			suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-		}
-		if (info.flags & MemBlockFlags::SUB_ALLOC) {
-			suballocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		} else if (info.flags & MemBlockFlags::SUB_FREE) {
-			// Maintain the previous allocation tag for debugging.
-			suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-		}
-		if (info.flags & MemBlockFlags::TEXTURE) {
-			textureMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		}
-		if (info.flags & MemBlockFlags::WRITE) {
-			writeMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		}
+static inline bool CanCoalesce(const PendingNotifyMem &a, const PendingNotifyMem &b) {
+	if (a.flags != b.flags || a.pc != b.pc)
+		return false;
+	// Only directly following or repeated ranges, which Mark() would merge anyway.
+	if (a.start + a.size != b.start && (a.start != b.start || a.size != b.size))
+		return false;
+	return strcmp(a.tag, b.tag) == 0;
+}
+
+static void CompactMemTagsLocked() {
+	// Tags only ever get added, so drop the ones no slab uses anymore (like old display list addresses.)
+	MemTagTable used;
+	allocMap.RemapTags(memTags, used);
+	suballocMap.RemapTags(memTags, used);
+	writeMap.RemapTags(memTags, used);
+	textureMap.RemapTags(memTags, used);
+	memTags.Swap(used);
+	// If most are still in use, wait until it's grown a good deal more.
+	memTagsCompactAt = std::max(MIN_TAGS_COMPACT, memTags.Size() * 2);
+}
+
+static void ApplyPendingMemInfo(const PendingNotifyMem &info) {
+	if (memTags.Size() >= memTagsCompactAt)
+		CompactMemTagsLocked();
+	uint32_t tag = memTags.Intern(info.tag);
+	if (info.flags & MemBlockFlags::ALLOC) {
+		allocMap.Mark(info.start, info.size, info.ticks, info.pc, true, tag);
+	} else if (info.flags & MemBlockFlags::FREE) {
+		// Maintain the previous allocation tag for debugging.
+		allocMap.Mark(info.start, info.size, info.ticks, 0, false, MemSlabMap::KEEP_TAG);
+		suballocMap.Mark(info.start, info.size, info.ticks, 0, false, MemSlabMap::KEEP_TAG);
+	}
+	if (info.flags & MemBlockFlags::SUB_ALLOC) {
+		suballocMap.Mark(info.start, info.size, info.ticks, info.pc, true, tag);
+	} else if (info.flags & MemBlockFlags::SUB_FREE) {
+		// Maintain the previous allocation tag for debugging.
+		suballocMap.Mark(info.start, info.size, info.ticks, 0, false, MemSlabMap::KEEP_TAG);
+	}
+	if (info.flags & MemBlockFlags::TEXTURE) {
+		textureMap.Mark(info.start, info.size, info.ticks, info.pc, true, tag);
 	}
-	pendingNotifies.clear();
+	if (info.flags & MemBlockFlags::WRITE) {
+		writeMap.Mark(info.start, info.size, info.ticks, info.pc, true, tag);
+	}
+}
+
+static void FlushPendingMemInfoLocked() {
+	// Reset before draining, so anything appended meanwhile keeps its range visible.
 	pendingNotifyMinAddr = 0xFFFFFFFF;
 	pendingNotifyMaxAddr = 0;
+
+	flushScratch.clear();
+	int sources = 0;
+	int count = notifyBufferCount.load(std::memory_order_acquire);
+	for (int i = 0; i < count; ++i) {
+		PendingNotifyBuffer *buffer = notifyBuffers[i];
+		uint32_t head = buffer->head.load(std::memory_order_acquire);
+		uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+		if (head == tail)
+			continue;
+
+		for (uint32_t pos = tail; pos != head; ++pos)
+			flushScratch.push_back(buffer->entries[pos % MAX_PENDING_NOTIFIES]);
+		buffer->tail.store(head, std::memory_order_release);
+		sources++;
+	}
+
+	if (flushScratch.empty())
+		return;
+	// Each buffer is already in order, only interleaving threads need sorting.
+	if (sources > 1) {
+		std::sort(flushScratch.begin(), flushScratch.end(), [](const PendingNotifyMem &a, const PendingNotifyMem &b) {
+			return a.seq < b.seq;
+		});
+	}
+
+	// Coalesce runs (like rasterizer rows) before they hit the slab maps.
+	PendingNotifyMem *run = &flushScratch[0];
+	for (size_t i = 1; i < flushScratch.size(); ++i) {
+		const PendingNotifyMem &info = flushScratch[i];
+		if (CanCoalesce(*run, info)) {
+			run->size = info.start + info.size - run->start;
+			run->ticks = info.ticks;
+			continue;
+		}
+		ApplyPendingMemInfo(*run);
+		run = &flushScratch[i];
+	}
+	ApplyPendingMemInfo(*run);
+}
+
+void FlushPendingMemInfo() {
+	std::lock_guard<std::mutex> guard(memInfoMutex);
+	FlushPendingMemInfoLocked();
+}
+
+static PendingNotifyBuffer *AcquireNotifyBuffer() {
+	std::lock_guard<std::mutex> guard(memInfoMutex);
+	int count = notifyBufferCount.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i) {
+		if (!notifyBuffers[i]->inUse) {
+			notifyBuffers[i]->inUse = true;
+			return notifyBuffers[i];
+		}
+	}
+	if (count >= MAX_NOTIFY_BUFFERS)
+		return nullptr;
+
+	// These are never freed, exiting threads hand theirs back for reuse.
+	PendingNotifyBuffer *buffer = new PendingNotifyBuffer();
+	buffer->inUse = true;
+	notifyBuffers[count] = buffer;
+	notifyBufferCount.store(count + 1, std::memory_order_release);
+	return buffer;
+}
+
+static void ReleaseNotifyBuffer(PendingNotifyBuffer *buffer) {
+	std::lock_guard<std::mutex> guard(memInfoMutex);
+	FlushPendingMemInfoLocked();
+	buffer->inUse = false;
+}
+
+static inline void ExpandPendingRange(uint32_t start, uint32_t end) {
+	uint32_t minAddr = pendingNotifyMinAddr.load(std::memory_order_relaxed);
+	while (start < minAddr && !pendingNotifyMinAddr.compare_exchange_weak(minAddr, start, std::memory_order_relaxed))
+		continue;
+	uint32_t maxAddr = pendingNotifyMaxAddr.load(std::memory_order_relaxed);
+	while (end > maxAddr && !pendingNotifyMaxAddr.compare_exchange_weak(maxAddr, end, std::memory_order_relaxed))
+		continue;
+}
+
+static void QueuePendingMemInfo(const PendingNotifyMem &info) {
+#if MEMINFO_THREAD_BUFFERS
+	PendingNotifyThreadSlot &slot = notifyThreadSlot;
+	if (!slot.buffer && !slot.exhausted) {
+		slot.buffer = AcquireNotifyBuffer();
+		slot.exhausted = slot.buffer == nullptr;
+	}
+
+	PendingNotifyBuffer *buffer = slot.buffer;
+#else
+	PendingNotifyBuffer *buffer = nullptr;
+#endif
+	if (!buffer) {
+		// Too many threads, just apply directly.
+		std::lock_guard<std::mutex> guard(memInfoMutex);
+		FlushPendingMemInfoLocked();
+		ApplyPendingMemInfo(info);
+		return;
+	}
+
+	uint32_t head = buffer->head.load(std::memory_order_relaxed);
+	if (head - buffer->tail.load(std::memory_order_acquire) >= MAX_PENDING_NOTIFIES)
+		FlushPendingMemInfo();
+
+	buffer->entries[head % MAX_PENDING_NOTIFIES] = info;
+	buffer->head.store(head + 1, std::memory_order_release);
+	ExpandPendingRange(info.start, info.start + info.size);
 }
 
 void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_t pc, const char *tagStr, size_t strLength) {
@@ -388,12 +663,12 @@ void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_
 	// Clear the uncached and kernel bits.
 	start &= ~0xC0000000;
 
-	bool needFlush = false;
-	// When the setting is off, we skip smaller info to keep things fast.
-	if (size >= 0x100 || MemBlockInfoDetailed()) {
-		PendingNotifyMem info{ flags, start, size };
+	// Reads aren't tracked in the maps, and when the setting is off, we skip smaller info to keep things fast.
+	const MemBlockFlags tracked = MemBlockFlags::ALLOC | MemBlockFlags::SUB_ALLOC | MemBlockFlags::WRITE | MemBlockFlags::TEXTURE | MemBlockFlags::FREE | MemBlockFlags::SUB_FREE;
+	if ((flags & tracked) && (size >= 0x100 || MemBlockInfoDetailed())) {
+		PendingNotifyMem info{ flags, start, size, pc };
 		info.ticks = CoreTiming::GetTicks();
-		info.pc = pc;
+		info.seq = pendingNotifySeq.fetch_add(1, std::memory_order_relaxed);
 
 		size_t copyLength = strLength;
 		if (copyLength >= sizeof(info.tag)) {
@@ -402,15 +677,7 @@ void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_
 		memcpy(info.tag, tagStr, copyLength);
 		info.tag[copyLength] = 0;
 
-		std::lock_guard<std::mutex> guard(pendingMutex);
-		pendingNotifyMinAddr = std::min(pendingNotifyMinAddr.load(), start);
-		pendingNotifyMaxAddr = std::max(pendingNotifyMaxAddr.load(), start + size);
-		pendingNotifies.push_back(info);
-		needFlush = pendingNotifies.size() > MAX_PENDING_NOTIFIES;
-	}
-
-	if (needFlush) {
-		FlushPendingMemInfo();
+		QueuePendingMemInfo(info);
 	}
 
 	if (!(flags & MemBlockFlags::SKIP_MEMCHECK)) {
@@ -429,8 +696,9 @@ void NotifyMemInfo(MemBlockFlags flags, uint32_t start, uint32_t size, const cha
 std::vector<MemBlockInfo> FindMemInfo(uint32_t start, uint32_t size) {
 	start &= ~0xC0000000;
 
+	std::lock_guard<std::mutex> guard(memInfoMutex);
 	if (pendingNotifyMinAddr < start + size && pendingNotifyMaxAddr >= start)
-		FlushPendingMemInfo();
+		FlushPendingMemInfoLocked();
 
 	std::vector<MemBlockInfo> results;
 	allocMap.Find(MemBlockFlags::ALLOC, start, size, results);
@@ -443,8 +711,9 @@ std::vector<MemBlockInfo> FindMemInfo(uint32_t start, uint32_t size) {
 std::vector<MemBlockInfo> FindMemInfoByFlag(MemBlockFlags flags, uint32_t start, uint32_t size) {
 	start &= ~0xC0000000;
 
+	std::lock_guard<std::mutex> guard(memInfoMutex);
 	if (pendingNotifyMinAddr < start + size && pendingNotifyMaxAddr >= start)
-		FlushPendingMemInfo();
+		FlushPendingMemInfoLocked();
 
 	std::vector<MemBlockInfo> results;
 	if (flags & MemBlockFlags::ALLOC)
@@ -473,19 +742,26 @@ std::string GetMemWriteTagAt(uint32_t start, uint32_t size) {
 }
 
 void MemBlockInfoInit() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
-	pendingNotifies.reserve(MAX_PENDING_NOTIFIES);
+	std::lock_guard<std::mutex> guard(memInfoMutex);
+	flushScratch.reserve(MAX_PENDING_NOTIFIES);
 	pendingNotifyMinAddr = 0xFFFFFFFF;
 	pendingNotifyMaxAddr = 0;
 }
 
 void MemBlockInfoShutdown() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
+	std::lock_guard<std::mutex> guard(memInfoMutex);
 	allocMap.Reset();
 	suballocMap.Reset();
 	writeMap.Reset();
 	textureMap.Reset();
-	pendingNotifies.clear();
+	memTags.Reset();
+	memTagsCompactAt = MIN_TAGS_COMPACT;
+
+	// Drop anything still queued.
+	int count = notifyBufferCount.load(std::memory_order_acquire);
+	for (int i = 0; i < count; ++i)
+		notifyBuffers[i]->tail.store(notifyBuffers[i]->head.load(std::memory_order_acquire), std::memory_order_release);
+	flushScratch.clear();
 }
 
 void MemBlockInfoDoState(PointerWrap &p) {
@@ -493,7 +769,8 @@ void MemBlockInfoDoState(PointerWrap &p) {
 	if (!s)
 		return;
 
-	FlushPendingMemInfo();
+	std::lock_guard<std::mutex> guard(memInfoMutex);
+	FlushPendingMemInfoLocked();
 	allocMap.DoState(p);
 	suballocMap.DoState(p);
 	writeMap.DoState(p);
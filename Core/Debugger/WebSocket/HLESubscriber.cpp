@@ -15,6 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
+#include "Common/File/Path.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
@@ -25,9 +28,19 @@
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
 #include "Core/MIPS/MIPSStackWalk.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HLE/sceKernelThread.h"
 
+struct WebSocketHLEState : public DebuggerSubscriber {
+	~WebSocketHLEState() override;
+	void SyscallTrace(DebuggerRequest &req);
+
+protected:
+	bool traceEnabled_ = false;
+};
+
 DebuggerSubscriber *WebSocketHLEInit(DebuggerEventHandlerMap &map) {
+	auto p = new WebSocketHLEState();
 	map["hle.thread.list"] = &WebSocketHLEThreadList;
 	map["hle.thread.wake"] = &WebSocketHLEThreadWake;
 	map["hle.thread.stop"] = &WebSocketHLEThreadStop;
@@ -37,8 +50,18 @@ DebuggerSubscriber *WebSocketHLEInit(DebuggerEventHandlerMap &map) {
 	map["hle.func.rename"] = &WebSocketHLEFuncRename;
 	map["hle.module.list"] = &WebSocketHLEModuleList;
 	map["hle.backtrace"] = &WebSocketHLEBacktrace;
+	map["hle.syscall.stats"] = &WebSocketHLESyscallStats;
+	map["hle.syscall.reset"] = &WebSocketHLESyscallReset;
+	map["hle.syscall.trace"] = std::bind(&WebSocketHLEState::SyscallTrace, p, std::placeholders::_1);
+	map["hle.syscall.dump"] = &WebSocketHLESyscallDump;
 
-	return nullptr;
+	return p;
+}
+
+WebSocketHLEState::~WebSocketHLEState() {
+	// Don't leave debug stats forced on after the debugger disconnects.
+	if (traceEnabled_)
+		hleSetSyscallTrace(false, 0);
 }
 
 // List all current HLE threads (hle.thread.list)
@@ -489,3 +512,98 @@ void WebSocketHLEBacktrace(DebuggerRequest &req) {
 	}
 	json.pop();
 }
+
+// List time spent in each HLE function (hle.syscall.stats)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - syscalls: array of objects, sorted by most total time first, each with properties:
+//     - module: string name of the HLE module.
+//     - name: string name of the function.
+//     - calls: number of times called since the last reset.
+//     - total: total seconds spent in the function.
+//     - max: seconds spent in the slowest call.
+//     - histogram: array of call counts by duration, the first is under 1us, then doubling from 1us.
+//
+// Note: stats are only collected while debug stats are shown or hle.syscall.trace is enabled.
+void WebSocketHLESyscallStats(DebuggerRequest &req) {
+	std::vector<HLESyscallStats> stats;
+	hleGetSyscallStats(stats);
+	std::sort(stats.begin(), stats.end(), [](const HLESyscallStats &a, const HLESyscallStats &b) {
+		return a.totalTime > b.totalTime;
+	});
+
+	JsonWriter &json = req.Respond();
+	json.pushArray("syscalls");
+	for (const auto &st : stats) {
+		json.pushDict();
+		json.writeString("module", st.module);
+		json.writeString("name", st.name);
+		json.writeFloat("calls", (double)st.calls);
+		json.writeFloat("total", st.totalTime);
+		json.writeFloat("max", st.maxTime);
+		json.pushArray("histogram");
+		for (u32 count : st.histogram)
+			json.writeUint(count);
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+}
+
+// Reset HLE function stats (hle.syscall.reset)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+void WebSocketHLESyscallReset(DebuggerRequest &req) {
+	hleResetSyscallStats();
+	req.Respond();
+}
+
+// Enable or disable the HLE syscall trace (hle.syscall.trace)
+//
+// Parameters:
+//  - enabled: boolean, true to collect stats and trace syscalls.
+//  - capacity: unsigned integer number of recent calls to keep, optional (default 65536.)
+//    Use 0 to only collect stats.
+//
+// Response (same event name):
+//  - enabled: boolean, repeated back.
+void WebSocketHLEState::SyscallTrace(DebuggerRequest &req) {
+	bool enabled;
+	if (!req.ParamBool("enabled", &enabled))
+		return;
+	u32 capacity = 65536;
+	if (!req.ParamU32("capacity", &capacity, false, DebuggerParamType::OPTIONAL))
+		return;
+	if (capacity > 16 * 1024 * 1024)
+		return req.Fail("Capacity too large");
+
+	hleSetSyscallTrace(enabled, capacity);
+	traceEnabled_ = enabled;
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", enabled);
+}
+
+// Write the HLE syscall trace to a file (hle.syscall.dump)
+//
+// Parameters:
+//  - filename: string path on the host to write the binary trace to.
+//
+// Response (same event name):
+//  - records: number of syscalls written.
+void WebSocketHLESyscallDump(DebuggerRequest &req) {
+	std::string filename;
+	if (!req.ParamString("filename", &filename))
+		return;
+
+	int records = hleDumpSyscallTrace(Path(filename));
+	if (records < 0)
+		return req.Fail("Could not write trace, is hle.syscall.trace enabled?");
+
+	JsonWriter &json = req.Respond();
+	json.writeInt("records", records);
+}
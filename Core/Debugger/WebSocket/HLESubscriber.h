@@ -30,3 +30,6 @@ void WebSocketHLEFuncRemove(DebuggerRequest &req);
 void WebSocketHLEFuncRename(DebuggerRequest &req);
 void WebSocketHLEModuleList(DebuggerRequest &req);
 void WebSocketHLEBacktrace(DebuggerRequest &req);
+void WebSocketHLESyscallStats(DebuggerRequest &req);
+void WebSocketHLESyscallReset(DebuggerRequest &req);
+void WebSocketHLESyscallDump(DebuggerRequest &req);
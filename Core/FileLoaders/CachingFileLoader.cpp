@@ -16,13 +16,43 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <cstring>
-#include <thread>
 #include <algorithm>
 
-#include "Common/Thread/ThreadUtil.h"
+#include "Common/Log.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/TimeUtil.h"
 #include "Core/FileLoaders/CachingFileLoader.h"
 
+class CachingFileLoader::ReadAheadTask : public Task {
+public:
+	ReadAheadTask(CachingFileLoader *loader, s64 startBlock, s64 endBlock)
+		: loader_(loader), startBlock_(startBlock), endBlock_(endBlock) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	void Run() override {
+		loader_->ReadAhead(startBlock_, endBlock_);
+		loader_->aheadTasks_--;
+	}
+
+	// Only called instead of Run(), when the thread manager shuts down with this still queued.
+	bool Cancellable() override {
+		return true;
+	}
+
+	void Cancel() override {
+		loader_->aheadTasks_--;
+	}
+
+private:
+	CachingFileLoader *loader_;
+	s64 startBlock_;
+	s64 endBlock_;
+};
+
 // Takes ownership of backend.
 CachingFileLoader::CachingFileLoader(FileLoader *backend)
 	: ProxiedFileLoader(backend) {
@@ -40,6 +70,8 @@ void CachingFileLoader::Prepare() {
 CachingFileLoader::~CachingFileLoader() {
 	if (filesize_ > 0) {
 		ShutdownCache();
+		INFO_LOG(LOADER, "Read cache: %lld hits, %lld misses, %lld KB read ahead, %lld KB of that unused",
+			(long long)stats_.hitReads, (long long)stats_.missReads, (long long)(stats_.prefetchedBytes / 1024), (long long)(stats_.wastedPrefetchBytes / 1024));
 	}
 }
 
@@ -82,6 +114,7 @@ size_t CachingFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flag
 		readSize = backend_->ReadAt(absolutePos, bytes, data, flags);
 	} else {
 		readSize = ReadFromCache(absolutePos, bytes, data);
+		const bool hit = readSize >= bytes;
 		// While in case the cache size is too small for the entire read.
 		while (readSize < bytes) {
 			SaveIntoCache(absolutePos + readSize, bytes - readSize, flags);
@@ -93,12 +126,24 @@ size_t CachingFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flag
 			}
 		}
 
-		StartReadAhead(absolutePos + readSize);
+		if (bytes > 0) {
+			std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
+			if (hit)
+				stats_.hitReads++;
+			else
+				stats_.missReads++;
+			UpdateCursors(absolutePos >> BLOCK_SHIFT, (absolutePos + bytes - 1) >> BLOCK_SHIFT);
+		}
 	}
 
 	return readSize;
 }
 
+CachingFileLoader::Stats CachingFileLoader::GetStats() {
+	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
+	return stats_;
+}
+
 void CachingFileLoader::InitCache() {
 	cacheSize_ = 0;
 	oldestGeneration_ = 0;
@@ -107,20 +152,16 @@ void CachingFileLoader::InitCache() {
 
 void CachingFileLoader::ShutdownCache() {
 	// TODO: Maybe add some hint that deletion is coming soon?
-	// We can't delete while the thread is running, so have to wait.
+	// We can't delete while read ahead is running, so have to wait.
 	// This should only happen from the menu.
-	while (aheadThreadRunning_) {
+	while (aheadTasks_ > 0) {
 		sleep_ms(1);
 	}
-	if (aheadThread_.joinable())
-		aheadThread_.join();
 
 	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
-	for (auto block : blocks_) {
-		delete [] block.second.ptr;
+	for (auto it = blocks_.begin(); it != blocks_.end(); ) {
+		it = EvictBlock(it);
 	}
-	blocks_.clear();
-	cacheSize_ = 0;
 }
 
 size_t CachingFileLoader::ReadFromCache(s64 pos, size_t bytes, void *data) {
@@ -138,6 +179,7 @@ size_t CachingFileLoader::ReadFromCache(s64 pos, size_t bytes, void *data) {
 			return readSize;
 		}
 		block->second.generation = generation_;
+		block->second.prefetched = false;
 
 		size_t toRead = std::min(bytes - readSize, (size_t)BLOCK_SIZE - offset);
 		memcpy(p + readSize, block->second.ptr + offset, toRead);
@@ -170,6 +212,8 @@ void CachingFileLoader::SaveIntoCache(s64 pos, size_t bytes, Flags flags, bool r
 		return;
 	}
 
+	// Other threads may insert some of these blocks meanwhile, only count ours.
+	size_t blocksAdded = 0;
 	if (blocksToRead == 1) {
 		blocksMutex_.unlock();
 
@@ -181,6 +225,8 @@ void CachingFileLoader::SaveIntoCache(s64 pos, size_t bytes, Flags flags, bool r
 		// If so, free the one we just read.
 		if (blocks_.find(cacheStartPos) == blocks_.end()) {
 			blocks_[cacheStartPos] = BlockInfo(buf);
+			blocks_[cacheStartPos].prefetched = readingAhead;
+			++blocksAdded;
 		} else {
 			delete [] buf;
 		}
@@ -199,22 +245,35 @@ void CachingFileLoader::SaveIntoCache(s64 pos, size_t bytes, Flags flags, bool r
 			u8 *buf = new u8[BLOCK_SIZE];
 			memcpy(buf, wholeRead + (i << BLOCK_SHIFT), BLOCK_SIZE);
 			blocks_[cacheStartPos + i] = BlockInfo(buf);
+			blocks_[cacheStartPos + i].prefetched = readingAhead;
+			++blocksAdded;
 		}
 		delete[] wholeRead;
 	}
 
-	cacheSize_ += blocksToRead;
+	cacheSize_ += blocksAdded;
+	if (readingAhead)
+		stats_.prefetchedBytes += blocksAdded << BLOCK_SHIFT;
 	++generation_;
 }
 
 bool CachingFileLoader::MakeCacheSpaceFor(size_t blocks, bool readingAhead) {
 	size_t goal = MAX_BLOCKS_CACHED - blocks;
 
+	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
+	// Blocks a stream already went past are the cheapest to lose.
+	for (auto it = blocks_.begin(); it != blocks_.end() && cacheSize_ > goal; ) {
+		if (it->second.consumed) {
+			it = EvictBlock(it);
+		} else {
+			++it;
+		}
+	}
+
 	if (readingAhead && cacheSize_ > goal) {
 		return false;
 	}
 
-	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
 	while (cacheSize_ > goal) {
 		u64 minGeneration = generation_;
 
@@ -228,16 +287,10 @@ bool CachingFileLoader::MakeCacheSpaceFor(size_t blocks, bool readingAhead) {
 
 			// 0 means it was never used yet or was the first read (e.g. block descriptor.)
 			if (it->second.generation == oldestGeneration_ || it->second.generation == 0) {
-				s64 pos = it->first;
-				delete it->second.ptr;
-				blocks_.erase(it);
-				--cacheSize_;
-
-				// Our iterator is invalid now.  Keep going?
-				if (cacheSize_ > goal) {
-					// This finds the one at that position.
-					it = blocks_.lower_bound(pos);
-				} else {
+				it = EvictBlock(it);
+
+				// Keep going?
+				if (cacheSize_ <= goal) {
 					break;
 				}
 			} else {
@@ -252,36 +305,84 @@ bool CachingFileLoader::MakeCacheSpaceFor(size_t blocks, bool readingAhead) {
 	return true;
 }
 
-void CachingFileLoader::StartReadAhead(s64 pos) {
-	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
-	if (aheadThreadRunning_) {
-		// Already going.
-		return;
-	}
-	if (cacheSize_ + BLOCK_READAHEAD > MAX_BLOCKS_CACHED) {
-		// Not enough space to readahead.
-		return;
+CachingFileLoader::BlockMap::iterator CachingFileLoader::EvictBlock(BlockMap::iterator it) {
+	if (it->second.prefetched) {
+		stats_.wastedPrefetchBytes += BLOCK_SIZE;
 	}
+	delete [] it->second.ptr;
+	--cacheSize_;
+	return blocks_.erase(it);
+}
 
-	aheadThreadRunning_ = true;
-	if (aheadThread_.joinable())
-		aheadThread_.join();
-	aheadThread_ = std::thread([this, pos] {
-		SetCurrentThreadName("FileLoaderReadAhead");
-
-		std::unique_lock<std::recursive_mutex> guard(blocksMutex_);
-		s64 cacheStartPos = pos >> BLOCK_SHIFT;
-		s64 cacheEndPos = cacheStartPos + BLOCK_READAHEAD - 1;
+void CachingFileLoader::UpdateCursors(s64 startBlock, s64 endBlock) {
+	ReadCursor *cursor = nullptr;
+	for (ReadCursor &c : cursors_) {
+		if (c.lastBlock < 0) {
+			continue;
+		}
+		if (startBlock == c.lastBlock || startBlock == c.lastBlock + 1) {
+			// Picked up right where it left off, so read further ahead.
+			c.window = std::max(1, std::min(c.window * 2, (int)MAX_READAHEAD));
+			cursor = &c;
+			break;
+		}
+		if (startBlock > c.lastBlock + 1 && startBlock <= c.lastBlock + 1 + c.window) {
+			// Skipped some of what we read ahead, so be less eager.
+			c.window /= 2;
+			cursor = &c;
+			break;
+		}
+	}
 
-		for (s64 i = cacheStartPos; i <= cacheEndPos; ++i) {
+	if (cursor) {
+		for (s64 i = cursor->lastBlock; i < endBlock; ++i) {
 			auto block = blocks_.find(i);
-			if (block == blocks_.end()) {
-				guard.unlock();
-				SaveIntoCache(i << BLOCK_SHIFT, BLOCK_SIZE * BLOCK_READAHEAD, Flags::NONE, true);
-				break;
+			if (block != blocks_.end()) {
+				block->second.consumed = true;
+			}
+		}
+	} else {
+		// Random access or a new stream, take over the least recently used cursor.
+		cursor = &cursors_[0];
+		for (ReadCursor &c : cursors_) {
+			if (c.lastUsed < cursor->lastUsed) {
+				cursor = &c;
 			}
 		}
+		*cursor = ReadCursor();
+	}
+
+	cursor->lastBlock = endBlock;
+	cursor->lastUsed = ++cursorClock_;
+
+	const s64 lastFileBlock = (filesize_ - 1) >> BLOCK_SHIFT;
+	const s64 aheadStart = std::max(endBlock + 1, cursor->aheadEnd);
+	const s64 aheadEnd = std::min(endBlock + 1 + cursor->window, lastFileBlock + 1);
+	if (aheadStart < aheadEnd && aheadTasks_ < MAX_AHEAD_TASKS && g_threadManager.IsInitialized()) {
+		cursor->aheadEnd = aheadEnd;
+		StartReadAhead(aheadStart, aheadEnd);
+	}
+}
+
+void CachingFileLoader::StartReadAhead(s64 startBlock, s64 endBlock) {
+	aheadTasks_++;
+	g_threadManager.EnqueueTask(new ReadAheadTask(this, startBlock, endBlock));
+}
+
+void CachingFileLoader::ReadAhead(s64 startBlock, s64 endBlock) {
+	std::unique_lock<std::recursive_mutex> guard(blocksMutex_);
+	for (s64 i = startBlock; i < endBlock; ++i) {
+		if (blocks_.find(i) != blocks_.end()) {
+			continue;
+		}
 
-		aheadThreadRunning_ = false;
-	});
+		guard.unlock();
+		SaveIntoCache(i << BLOCK_SHIFT, (size_t)(endBlock - i) << BLOCK_SHIFT, Flags::NONE, true);
+		guard.lock();
+
+		if (blocks_.find(i) == blocks_.end()) {
+			// No room to read ahead.
+			break;
+		}
+	}
 }
@@ -17,9 +17,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <mutex>
-#include <thread>
 
 #include "Common/CommonTypes.h"
 #include "Core/Loaders.h"
@@ -39,6 +39,14 @@ class CachingFileLoader : public ProxiedFileLoader {
 	}
 	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override;
 
+	struct Stats {
+		u64 hitReads;
+		u64 missReads;
+		u64 prefetchedBytes;
+		u64 wastedPrefetchBytes;
+	};
+	Stats GetStats();
+
 private:
 	void Prepare();
 	void InitCache();
@@ -47,14 +55,21 @@ class CachingFileLoader : public ProxiedFileLoader {
 	// Guaranteed to read at least one block into the cache.
 	void SaveIntoCache(s64 pos, size_t bytes, Flags flags, bool readingAhead = false);
 	bool MakeCacheSpaceFor(size_t blocks, bool readingAhead);
-	void StartReadAhead(s64 pos);
+	// Matches the read to a sequential stream, and reads ahead for it.
+	void UpdateCursors(s64 startBlock, s64 endBlock);
+	void StartReadAhead(s64 startBlock, s64 endBlock);
+	void ReadAhead(s64 startBlock, s64 endBlock);
+
+	class ReadAheadTask;
 
 	enum {
 		BLOCK_SIZE = 65536,
 		BLOCK_SHIFT = 16,
 		MAX_BLOCKS_PER_READ = 16,
 		MAX_BLOCKS_CACHED = 4096, // 256 MB
-		BLOCK_READAHEAD = 4,
+		MAX_READAHEAD = 16,
+		MAX_CURSORS = 4,
+		MAX_AHEAD_TASKS = 2,
 	};
 
 	s64 filesize_ = 0;
@@ -67,6 +82,10 @@ class CachingFileLoader : public ProxiedFileLoader {
 	struct BlockInfo {
 		u8 *ptr;
 		u64 generation;
+		// Read ahead, and not yet read by anyone.
+		bool prefetched = false;
+		// Already read by a sequential stream, so unlikely to be needed again.
+		bool consumed = false;
 
 		BlockInfo() : ptr(nullptr), generation(0) {
 		}
@@ -74,9 +93,24 @@ class CachingFileLoader : public ProxiedFileLoader {
 		}
 	};
 
-	std::map<s64, BlockInfo> blocks_;
+	// Tracks one sequential reader, e.g. a video or audio stream.
+	struct ReadCursor {
+		s64 lastBlock = -1;
+		// Blocks before this were already requested for read ahead.
+		s64 aheadEnd = 0;
+		int window = 0;
+		u64 lastUsed = 0;
+	};
+
+	typedef std::map<s64, BlockInfo> BlockMap;
+	// Returns the next block.
+	BlockMap::iterator EvictBlock(BlockMap::iterator it);
+
+	BlockMap blocks_;
 	std::recursive_mutex blocksMutex_;
-	bool aheadThreadRunning_ = false;
-	std::thread aheadThread_;
+	ReadCursor cursors_[MAX_CURSORS];
+	u64 cursorClock_ = 0;
+	std::atomic<int> aheadTasks_{ 0 };
+	Stats stats_{};
 	std::once_flag preparedFlag_;
 };
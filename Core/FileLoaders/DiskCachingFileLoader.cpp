@@ -38,12 +38,21 @@
 #define fseeko fseek
 #endif
 
+#if !PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(ANDROID) && !PPSSPP_PLATFORM(SWITCH)
+#define DISK_CACHE_SHARED 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
 static const char *CACHEFILE_MAGIC = "ppssppDC";
 static const s64 SAFETY_FREE_DISK_SPACE = 768 * 1024 * 1024; // 768 MB
 // Aim to allow this many files cached at once.
 static const u32 CACHE_SPACE_FLEX = 4;
 
 Path DiskCachingFileLoaderCache::cacheDir_;
+bool DiskCachingFileLoaderCache::shared_ = false;
 
 std::map<Path, DiskCachingFileLoaderCache *> DiskCachingFileLoader::caches_;
 std::mutex DiskCachingFileLoader::cachesMutex_;
@@ -173,6 +182,19 @@ void DiskCachingFileLoaderCache::InitCache(const Path &filename) {
 	generation_ = 0;
 
 	const Path cacheFilePath = MakeCacheFilePath(filename);
+	if (shared_ && !LockSharedCache(cacheFilePath)) {
+		// Someone else is filling the cache, just use what they have.
+		// The owner has finished validating or recreating it by now, and keeps it locked while open.
+		follower_ = LoadCacheFile(cacheFilePath) && (flags_ & FLAG_LOCKED) != 0;
+		if (follower_) {
+			INFO_LOG(LOADER, "Reading shared disk cache file for %s", origPath_.c_str());
+		} else {
+			CloseFileHandle();
+		}
+		FinishSharedInit();
+		return;
+	}
+
 	bool fileLoaded = LoadCacheFile(cacheFilePath);
 
 	// We do some basic locking to protect against two things: crashes and concurrency.
@@ -193,10 +215,18 @@ void DiskCachingFileLoaderCache::InitCache(const Path &filename) {
 			CloseFileHandle();
 		}
 	}
+	if (!f_) {
+		// Let another process try.
+		UnlockSharedCache();
+	}
+	FinishSharedInit();
 }
 
 void DiskCachingFileLoaderCache::ShutdownCache() {
-	if (f_) {
+	if (follower_) {
+		// Not ours to update.
+		CloseFileHandle();
+	} else if (f_) {
 		bool failed = false;
 		if (fseek(f_, sizeof(FileHeader), SEEK_SET) != 0) {
 			failed = true;
@@ -213,6 +243,7 @@ void DiskCachingFileLoaderCache::ShutdownCache() {
 		}
 		CloseFileHandle();
 	}
+	UnlockSharedCache();
 
 	index_.clear();
 	blockIndexLookup_.clear();
@@ -225,6 +256,9 @@ size_t DiskCachingFileLoaderCache::ReadFromCache(s64 pos, size_t bytes, void *da
 	if (!f_) {
 		return 0;
 	}
+	if (follower_) {
+		return ReadFromSharedCache(pos, bytes, data);
+	}
 
 	s64 cacheStartPos = pos / blockSize_;
 	s64 cacheEndPos = (pos + bytes - 1) / blockSize_;
@@ -261,6 +295,9 @@ size_t DiskCachingFileLoaderCache::SaveIntoCache(FileLoader *backend, s64 pos, s
 		// Just to keep things working.
 		return backend->ReadAt(pos, bytes, data, flags);
 	}
+	if (follower_) {
+		return ReadUncachedShared(backend, pos, bytes, data, flags);
+	}
 
 	s64 cacheStartPos = pos / blockSize_;
 	s64 cacheEndPos = (pos + bytes - 1) / blockSize_;
@@ -326,6 +363,11 @@ size_t DiskCachingFileLoaderCache::SaveIntoCache(FileLoader *backend, s64 pos, s
 	cacheSize_ += blocksToRead;
 	++generation_;
 
+	if (lockFd_ != -1 && f_) {
+		// Make the new blocks visible to other processes right away.
+		fflush(f_);
+	}
+
 	if (generation_ == std::numeric_limits<u16>::max()) {
 		RebalanceGenerations();
 	}
@@ -374,6 +416,11 @@ bool DiskCachingFileLoaderCache::MakeCacheSpaceFor(size_t blocks) {
 		oldestGeneration_ = minGeneration;
 	}
 
+	if (lockFd_ != -1 && f_) {
+		// Other processes must see blocks as gone before we reuse them.
+		fflush(f_);
+	}
+
 	return true;
 }
 
@@ -721,6 +768,135 @@ bool DiskCachingFileLoaderCache::LockCacheFile(bool lockStatus) {
 	return true;
 }
 
+bool DiskCachingFileLoaderCache::LockSharedCache(const Path &path) {
+#ifdef DISK_CACHE_SHARED
+	// Held until InitCache() is done, so followers never open a file the owner is still checking.
+	// Otherwise, one could load it just before the owner finds a stale FLAG_LOCKED and recreates it.
+	initLockFd_ = open(path.WithExtraExtension(".init").c_str(), O_RDWR | O_CREAT, 0666);
+	if (initLockFd_ == -1 || flock(initLockFd_, LOCK_EX) != 0) {
+		WARN_LOG(LOADER, "Unable to lock disk cache init file, not sharing");
+		FinishSharedInit();
+		return true;
+	}
+
+	// FLAG_LOCKED can't tell a running owner from a crashed one, but flock() can.
+	lockFd_ = open(path.WithExtraExtension(".lock").c_str(), O_RDWR | O_CREAT, 0666);
+	if (lockFd_ == -1) {
+		WARN_LOG(LOADER, "Unable to open disk cache lock file, not sharing");
+		return true;
+	}
+	if (flock(lockFd_, LOCK_EX | LOCK_NB) != 0) {
+		bool inUse = errno == EWOULDBLOCK;
+		close(lockFd_);
+		lockFd_ = -1;
+		return !inUse;
+	}
+#endif
+	return true;
+}
+
+void DiskCachingFileLoaderCache::UnlockSharedCache() {
+#ifdef DISK_CACHE_SHARED
+	if (lockFd_ != -1) {
+		// Closing releases the flock.
+		close(lockFd_);
+		lockFd_ = -1;
+	}
+#endif
+	FinishSharedInit();
+}
+
+void DiskCachingFileLoaderCache::FinishSharedInit() {
+#ifdef DISK_CACHE_SHARED
+	if (initLockFd_ != -1) {
+		close(initLockFd_);
+		initLockFd_ = -1;
+	}
+#endif
+}
+
+bool DiskCachingFileLoaderCache::ReadSharedIndex(u32 indexPos, BlockInfo &info) {
+#ifdef DISK_CACHE_SHARED
+	if (indexPos >= indexCount_) {
+		return false;
+	}
+	// Read around stdio, its buffers won't see the owner's writes.
+	off_t offset = (off_t)sizeof(FileHeader) + (off_t)indexPos * (off_t)sizeof(BlockInfo);
+	if (pread(fileno(f_), &info, sizeof(BlockInfo), offset) != (ssize_t)sizeof(BlockInfo)) {
+		return false;
+	}
+	if (info.block >= maxBlocks_) {
+		info.block = INVALID_BLOCK;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t DiskCachingFileLoaderCache::ReadFromSharedCache(s64 pos, size_t bytes, void *data) {
+	s64 cacheStartPos = pos / blockSize_;
+	s64 cacheEndPos = (pos + bytes - 1) / blockSize_;
+	size_t readSize = 0;
+	size_t offset = (size_t)(pos - (cacheStartPos * (u64)blockSize_));
+
+	for (s64 i = cacheStartPos; i <= cacheEndPos; ++i) {
+		BlockInfo info;
+		if (!ReadSharedIndex((u32)i, info) || info.block == INVALID_BLOCK) {
+			return readSize;
+		}
+
+		size_t toRead = std::min(bytes - readSize, (size_t)blockSize_ - offset);
+#ifdef DISK_CACHE_SHARED
+		if (pread(fileno(f_), (u8 *)data + readSize, toRead, (off_t)(GetBlockOffset(info.block) + offset)) != (ssize_t)toRead) {
+			return readSize;
+		}
+#endif
+
+		// The owner evicts by clearing the index entry first, so if it still matches, the data was good.
+		BlockInfo check;
+		if (!ReadSharedIndex((u32)i, check) || check.block != info.block) {
+			return readSize;
+		}
+		readSize += toRead;
+
+		// Don't need an offset after the first read.
+		offset = 0;
+	}
+	return readSize;
+}
+
+size_t DiskCachingFileLoaderCache::ReadUncachedShared(FileLoader *backend, s64 pos, size_t bytes, void *data, FileLoader::Flags flags) {
+	// Reads the whole range, using blocks the owner has cached where possible.
+	// If the owner evicts one before we get to it, we just read it from the backend too.
+	size_t readSize = 0;
+	while (readSize < bytes) {
+		const s64 readPos = pos + readSize;
+		const s64 cacheStartPos = readPos / blockSize_;
+		const s64 cacheEndPos = (pos + bytes - 1) / blockSize_;
+		s64 i = cacheStartPos + 1;
+		for (; i <= cacheEndPos; ++i) {
+			BlockInfo info;
+			if (ReadSharedIndex((u32)i, info) && info.block != INVALID_BLOCK) {
+				break;
+			}
+		}
+
+		const size_t toRead = std::min(bytes - readSize, (size_t)(i * (s64)blockSize_ - readPos));
+		const size_t backendRead = backend->ReadAt(readPos, toRead, (u8 *)data + readSize, flags);
+		readSize += backendRead;
+		if (backendRead < toRead) {
+			// Backend error, nothing more we can do.
+			break;
+		}
+
+		if (readSize < bytes) {
+			readSize += ReadFromSharedCache(pos + readSize, bytes - readSize, (u8 *)data + readSize);
+		}
+	}
+	return readSize;
+}
+
 bool DiskCachingFileLoaderCache::RemoveCacheFile(const Path &path) {
 	// Note that some platforms, you can't delete open files.  So we check.
 	CloseFileHandle();
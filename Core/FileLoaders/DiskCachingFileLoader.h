@@ -80,6 +80,15 @@ class DiskCachingFileLoaderCache {
 		cacheDir_ = path;
 	}
 
+	// Lets several processes use one cache file: the first fills it, the rest read from it.
+	static void SetShared(bool shared) {
+		shared_ = shared;
+	}
+
+	static bool IsShared() {
+		return shared_;
+	}
+
 	size_t ReadFromCache(s64 pos, size_t bytes, void *data);
 	// Guaranteed to read at least one block into the cache.
 	size_t SaveIntoCache(FileLoader *backend, s64 pos, size_t bytes, void *data, FileLoader::Flags flags);
@@ -105,6 +114,15 @@ class DiskCachingFileLoaderCache {
 	void LoadCacheIndex();
 	void CreateCacheFile(const Path &path);
 	bool LockCacheFile(bool lockStatus);
+	// Returns false if another process already owns the cache file.
+	// Waits for any other process still initializing it, see FinishSharedInit().
+	bool LockSharedCache(const Path &path);
+	void UnlockSharedCache();
+	// Lets other processes open the cache file, once we've validated it (or given up.)
+	void FinishSharedInit();
+	bool ReadSharedIndex(u32 indexPos, BlockInfo &info);
+	size_t ReadFromSharedCache(s64 pos, size_t bytes, void *data);
+	size_t ReadUncachedShared(FileLoader *backend, s64 pos, size_t bytes, void *data, FileLoader::Flags flags);
 	bool RemoveCacheFile(const Path &path);
 	void CloseFileHandle();
 
@@ -176,6 +194,13 @@ class DiskCachingFileLoaderCache {
 
 	FILE *f_ = nullptr;
 	int fd_ = 0;
+	// Held while we own a shared cache file.
+	int lockFd_ = -1;
+	// Held from LockSharedCache() until InitCache() is done with the file.
+	int initLockFd_ = -1;
+	// Another process owns the cache file, so we only read what it has cached.
+	bool follower_ = false;
 
 	static Path cacheDir_;
+	static bool shared_;
 };
@@ -15,7 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 #include "ppsspp_config.h"
 
@@ -23,6 +25,7 @@
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Profiler/Profiler.h"
 #include "Core/FileLoaders/LocalFileLoader.h"
 
 #if PPSSPP_PLATFORM(ANDROID)
@@ -33,6 +36,15 @@
 #include "Common/CommonWindows.h"
 #else
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Mapping the whole image needs plenty of address space, so only do it on 64-bit.
+// The catch is that an I/O error while reading mapped data crashes instead of failing the read,
+// so files opened through a descriptor (like Android content URIs) are never mapped.
+#if PPSSPP_ARCH(64BIT) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(UWP)
+#define LOCAL_FILE_LOADER_MMAP 1
 #endif
 
 #ifndef _WIN32
@@ -80,6 +92,7 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 
 	DetectSizeFd();
+	MapFile();
 
 #else // _WIN32
 
@@ -102,10 +115,60 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 	filesize_ = end_offset.QuadPart;
 	SetFilePointerEx(handle_, zero, nullptr, FILE_BEGIN);
+	MapFile();
 #endif // _WIN32
 }
 
+void LocalFileLoader::MapFile() {
+#ifdef LOCAL_FILE_LOADER_MMAP
+	if (filesize_ == 0 || filesize_ != (u64)(size_t)filesize_)
+		return;
+
+#ifndef _WIN32
+	if (fd_ == -1 || isOpenedByFd_)
+		return;
+	void *ptr = mmap(nullptr, (size_t)filesize_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (ptr == MAP_FAILED) {
+		WARN_LOG(FILESYS, "LocalFileLoader: failed to map '%s', falling back to reads", filename_.c_str());
+		return;
+	}
+	mapped_ = (u8 *)ptr;
+#else
+	if (handle_ == INVALID_HANDLE_VALUE)
+		return;
+	mapping_ = CreateFileMapping(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_) {
+		WARN_LOG(FILESYS, "LocalFileLoader: failed to map '%s', falling back to reads", filename_.c_str());
+		return;
+	}
+	mapped_ = (u8 *)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped_) {
+		WARN_LOG(FILESYS, "LocalFileLoader: failed to map view of '%s', falling back to reads", filename_.c_str());
+		CloseHandle(mapping_);
+		mapping_ = 0;
+	}
+#endif
+#endif
+}
+
+void LocalFileLoader::UnmapFile() {
+#ifdef LOCAL_FILE_LOADER_MMAP
+#ifndef _WIN32
+	if (mapped_)
+		munmap(mapped_, (size_t)filesize_);
+#else
+	if (mapped_)
+		UnmapViewOfFile(mapped_);
+	if (mapping_)
+		CloseHandle(mapping_);
+	mapping_ = 0;
+#endif
+	mapped_ = nullptr;
+#endif
+}
+
 LocalFileLoader::~LocalFileLoader() {
+	UnmapFile();
 #ifndef _WIN32
 	if (fd_ != -1) {
 		close(fd_);
@@ -156,11 +219,24 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 	if (bytes == 0)
 		return 0;
 
+	PROFILE_THIS_SCOPE("fileread");
+
 	if (filesize_ == 0) {
 		ERROR_LOG(FILESYS, "ReadAt from 0-sized file: %s", filename_.c_str());
 		return 0;
 	}
 
+	if (mapped_) {
+		if (absolutePos < 0 || (u64)absolutePos >= filesize_)
+			return 0;
+		count = std::min(count, (size_t)(filesize_ - absolutePos) / bytes);
+		memcpy(data, mapped_ + absolutePos, bytes * count);
+		// Large reads tend to be followed by more of the same file, so ask for the next chunk early.
+		if (bytes * count >= 0x10000)
+			Prefetch(absolutePos + bytes * count, bytes * count);
+		return count;
+	}
+
 #if PPSSPP_PLATFORM(SWITCH)
 	// Toolchain has no fancy IO API.  We must lock.
 	std::lock_guard<std::mutex> guard(readLock_);
@@ -195,3 +271,22 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 	return result == TRUE ? (size_t)read / bytes : -1;
 #endif
 }
+
+const u8 *LocalFileLoader::MappedData(s64 absolutePos, size_t bytes) {
+	if (!mapped_ || absolutePos < 0 || (u64)absolutePos + bytes > filesize_)
+		return nullptr;
+	return mapped_ + absolutePos;
+}
+
+void LocalFileLoader::Prefetch(s64 absolutePos, size_t bytes) {
+	if (!mapped_ || absolutePos < 0 || (u64)absolutePos >= filesize_)
+		return;
+	bytes = (size_t)std::min((u64)bytes, filesize_ - absolutePos);
+
+#if defined(LOCAL_FILE_LOADER_MMAP) && !defined(_WIN32)
+	static const uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+	uintptr_t start = (uintptr_t)(mapped_ + absolutePos) & ~pageMask;
+	uintptr_t end = (uintptr_t)(mapped_ + absolutePos + bytes);
+	madvise((void *)start, end - start, MADV_WILLNEED);
+#endif
+}
@@ -39,14 +39,22 @@ class LocalFileLoader : public FileLoader {
 		return filename_;
 	}
 	virtual size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
+	const u8 *MappedData(s64 absolutePos, size_t bytes) override;
+	void Prefetch(s64 absolutePos, size_t bytes) override;
 
 private:
+	void MapFile();
+	void UnmapFile();
+
 #ifndef _WIN32
 	void DetectSizeFd();
 	int fd_ = -1;
 #else
 	HANDLE handle_ = 0;
+	HANDLE mapping_ = 0;
 #endif
+	// Read-only view of the whole file, if it could be mapped.
+	u8 *mapped_ = nullptr;
 	u64 filesize_ = 0;
 	Path filename_;
 	std::mutex readLock_;
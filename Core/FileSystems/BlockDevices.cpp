@@ -53,6 +53,34 @@ BlockDevice *constructBlockDevice(FileLoader *fileLoader) {
 	return new FileBlockDevice(fileLoader);
 }
 
+bool BlockDevice::ReadBytes(u64 offset, size_t size, u8 *outPtr) {
+	const size_t blockSize = (size_t)GetBlockSize();
+	u32 block = (u32)(offset / blockSize);
+	const size_t headOffset = (size_t)(offset % blockSize);
+	u8 temp[2048];
+	bool success = true;
+
+	if (headOffset != 0 && size > 0) {
+		const size_t headSize = std::min(size, blockSize - headOffset);
+		success = ReadBlock(block++, temp) && success;
+		memcpy(outPtr, temp + headOffset, headSize);
+		outPtr += headSize;
+		size -= headSize;
+	}
+	if (size >= blockSize) {
+		const int count = (int)(size / blockSize);
+		success = ReadBlocks(block, count, outPtr) && success;
+		block += count;
+		outPtr += count * blockSize;
+		size -= count * blockSize;
+	}
+	if (size > 0) {
+		success = ReadBlock(block, temp) && success;
+		memcpy(outPtr, temp, size);
+	}
+	return success;
+}
+
 u32 BlockDevice::CalculateCRC(volatile bool *cancel) {
 	u32 crc = crc32(0, Z_NULL, 0);
 
@@ -87,6 +115,12 @@ FileBlockDevice::~FileBlockDevice() {
 }
 
 bool FileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
+	const u8 *mapped = fileLoader_->MappedData((u64)blockNumber * (u64)GetBlockSize(), 2048);
+	if (mapped) {
+		memcpy(outPtr, mapped, 2048);
+		return true;
+	}
+
 	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
 	if (fileLoader_->ReadAt((u64)blockNumber * (u64)GetBlockSize(), 1, 2048, outPtr, flags) != 2048) {
 		DEBUG_LOG(FILESYS, "Could not read 2048 bytes from block");
@@ -97,6 +131,13 @@ bool FileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
 }
 
 bool FileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	// Copy straight out of the mapping when we can, skipping any caching layers.
+	const u8 *mapped = fileLoader_->MappedData((u64)minBlock * (u64)GetBlockSize(), 2048 * (size_t)count);
+	if (mapped) {
+		memcpy(outPtr, mapped, 2048 * (size_t)count);
+		return true;
+	}
+
 	if (fileLoader_->ReadAt((u64)minBlock * (u64)GetBlockSize(), 2048, count, outPtr) != (size_t)count) {
 		ERROR_LOG(FILESYS, "Could not read %d bytes from block", 2048 * count);
 		return false;
@@ -104,6 +145,21 @@ bool FileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	return true;
 }
 
+bool FileBlockDevice::ReadBytes(u64 offset, size_t size, u8 *outPtr) {
+	// Uncompressed, so any range can go straight into outPtr without partial blocks.
+	const u8 *mapped = fileLoader_->MappedData((s64)offset, size);
+	if (mapped) {
+		memcpy(outPtr, mapped, size);
+		return true;
+	}
+
+	if (fileLoader_->ReadAt((s64)offset, size, outPtr) != size) {
+		ERROR_LOG(FILESYS, "Could not read %d bytes at %llx", (int)size, (unsigned long long)offset);
+		return false;
+	}
+	return true;
+}
+
 // .CSO format
 
 // compressed ISO(9660) header format
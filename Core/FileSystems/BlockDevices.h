@@ -43,6 +43,9 @@ class BlockDevice {
 		}
 		return true;
 	}
+	// Reads a byte range, which doesn't need to be block aligned.  By default, only the
+	// unaligned head and tail go through a temporary block, the rest is read in place.
+	virtual bool ReadBytes(u64 offset, size_t size, u8 *outPtr);
 	int GetBlockSize() const { return 2048;}  // forced, it cannot be changed by subclasses
 	virtual u32 GetNumBlocks() = 0;
 	virtual bool IsDisc() = 0;
@@ -84,6 +87,7 @@ class FileBlockDevice : public BlockDevice {
 	~FileBlockDevice();
 	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
 	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
+	bool ReadBytes(u64 offset, size_t size, u8 *outPtr) override;
 	u32 GetNumBlocks() override {return (u32)(filesize_ / GetBlockSize());}
 	bool IsDisc() override { return true; }
 
@@ -37,6 +37,7 @@
 #include "Common/File/DiskFree.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/SysError.h"
+#include "Common/TimeUtil.h"
 #include "Core/FileSystems/DirectoryFileSystem.h"
 #include "Core/FileSystems/ISOFileSystem.h"
 #include "Core/HLE/sceKernel.h"
@@ -66,6 +67,12 @@
 #include <fcntl.h>
 #endif
 
+// Buffered writes are flushed once they reach this size or age (in seconds.)
+static const size_t WRITE_BACK_MAX_SIZE = 256 * 1024;
+static const double WRITE_BACK_MAX_AGE = 1.0;
+// Below this much free host space, write through so a full disk is reported to the game.
+static const int64_t WRITE_BACK_MIN_FREE = 32 * 1024 * 1024;
+
 DirectoryFileSystem::DirectoryFileSystem(IHandleAllocator *_hAlloc, const Path & _basePath, FileSystemFlags _flags) : basePath(_basePath), flags(_flags) {
 	File::CreateFullPath(basePath);
 	hAlloc = _hAlloc;
@@ -73,6 +80,9 @@ DirectoryFileSystem::DirectoryFileSystem(IHandleAllocator *_hAlloc, const Path &
 
 DirectoryFileSystem::~DirectoryFileSystem() {
 	CloseAll();
+	if (caseCacheHits_ != 0 || filePoolHits_ != 0) {
+		INFO_LOG(FILESYS, "DirectoryFileSystem(%s): %d case cache hits, %d reused file handles", basePath.c_str(), caseCacheHits_, filePoolHits_);
+	}
 }
 
 // TODO(scoped): Merge the two below functions somehow.
@@ -131,6 +141,8 @@ bool DirectoryFileHandle::Open(const Path &basePath, std::string &fileName, File
 	if (access & FILEACCESS_TRUNCATE) {
 		needsTrunc_ = 0;
 	}
+	// Appends always go to the end, so buffered positions would be wrong.
+	writeBack_ = (fileSystemFlags_ & FileSystemFlags::WRITE_BACK) && !(access & FILEACCESS_APPEND);
 
 	//TODO: tests, should append seek to end of file? seeking in a file opened for append?
 #if PPSSPP_PLATFORM(WINDOWS)
@@ -299,6 +311,7 @@ bool DirectoryFileHandle::Open(const Path &basePath, std::string &fileName, File
 
 size_t DirectoryFileHandle::Read(u8* pointer, s64 size)
 {
+	FlushWrites();
 	size_t bytesRead = 0;
 	if (needsTrunc_ != -1) {
 		// If the file was marked to be truncated, pretend there's nothing.
@@ -321,23 +334,34 @@ size_t DirectoryFileHandle::Read(u8* pointer, s64 size)
 	return replay_ ? ReplayApplyDiskRead(pointer, (uint32_t)bytesRead, (uint32_t)size, inGameDir_, CoreTiming::GetGlobalTimeUs()) : bytesRead;
 }
 
-size_t DirectoryFileHandle::Write(const u8* pointer, s64 size)
+size_t DirectoryFileHandle::Write(const u8* pointer, s64 size, bool mayBuffer)
 {
 	size_t bytesWritten = 0;
 	bool diskFull = false;
 
+	if (writeBack_ && mayBuffer && size > 0 && (size_t)size < WRITE_BACK_MAX_SIZE) {
+		double now = time_now_d();
+		if (pendingWrite_.empty())
+			pendingSince_ = now;
+		pendingWrite_.insert(pendingWrite_.end(), pointer, pointer + size);
+		bytesWritten = (size_t)size;
+		if (pendingWrite_.size() >= WRITE_BACK_MAX_SIZE || now - pendingSince_ >= WRITE_BACK_MAX_AGE)
+			FlushWrites();
+	} else {
+		FlushWrites();
 #ifdef _WIN32
-	BOOL success = ::WriteFile(hFile, (LPVOID)pointer, (DWORD)size, (LPDWORD)&bytesWritten, 0);
-	if (success == FALSE) {
-		DWORD err = GetLastError();
-		diskFull = err == ERROR_DISK_FULL || err == ERROR_NOT_ENOUGH_QUOTA;
-	}
+		BOOL success = ::WriteFile(hFile, (LPVOID)pointer, (DWORD)size, (LPDWORD)&bytesWritten, 0);
+		if (success == FALSE) {
+			DWORD err = GetLastError();
+			diskFull = err == ERROR_DISK_FULL || err == ERROR_NOT_ENOUGH_QUOTA;
+		}
 #else
-	bytesWritten = write(hFile, pointer, size);
-	if (bytesWritten == (size_t)-1) {
-		diskFull = errno == ENOSPC;
-	}
+		bytesWritten = write(hFile, pointer, size);
+		if (bytesWritten == (size_t)-1) {
+			diskFull = errno == ENOSPC;
+		}
 #endif
+	}
 	if (needsTrunc_ != -1) {
 		off_t off = (off_t)Seek(0, FILEMOVE_CURRENT);
 		if (needsTrunc_ < off) {
@@ -377,6 +401,13 @@ size_t DirectoryFileHandle::Seek(s32 position, FileMove type)
 		}
 	}
 
+	// Just asking for the position doesn't need a flush, but it includes the pending writes.
+	size_t pending = 0;
+	if (type == FILEMOVE_CURRENT && position == 0)
+		pending = pendingWrite_.size();
+	else
+		FlushWrites();
+
 	size_t result;
 #ifdef _WIN32
 	DWORD moveMethod = 0;
@@ -400,12 +431,59 @@ size_t DirectoryFileHandle::Seek(s32 position, FileMove type)
 	}
 	result = lseek(hFile, position, moveMethod);
 #endif
+	result += pending;
 
 	return replay_ ? (size_t)ReplayApplyDisk64(ReplayAction::FILE_SEEK, result, CoreTiming::GetGlobalTimeUs()) : result;
 }
 
+void DirectoryFileHandle::FlushWrites() {
+	if (pendingWrite_.empty())
+		return;
+
+	size_t size = pendingWrite_.size();
+	bool diskFull = false;
+#ifdef _WIN32
+	DWORD bytesWritten = 0;
+	if (::WriteFile(hFile, (LPCVOID)pendingWrite_.data(), (DWORD)size, &bytesWritten, 0) == FALSE) {
+		DWORD err = GetLastError();
+		diskFull = err == ERROR_DISK_FULL || err == ERROR_NOT_ENOUGH_QUOTA;
+	}
+#else
+	ssize_t bytesWritten = write(hFile, pendingWrite_.data(), size);
+	if (bytesWritten == -1) {
+		diskFull = errno == ENOSPC;
+	}
+#endif
+	pendingWrite_.clear();
+
+	// The game was already told these writes succeeded, all we can do is complain.
+	if ((size_t)bytesWritten != size) {
+		ERROR_LOG(FILESYS, "Failed to flush %d buffered bytes", (int)size);
+		if (diskFull) {
+			auto err = GetI18NCategory("Error");
+			host->NotifyUserMessage(err->T("Disk full while writing data"));
+		}
+	}
+}
+
+void DirectoryFileHandle::FlushWritesIfStale(double now) {
+	if (!pendingWrite_.empty() && now - pendingSince_ >= WRITE_BACK_MAX_AGE)
+		FlushWrites();
+}
+
+void DirectoryFileHandle::Rewind() {
+#ifdef _WIN32
+	LARGE_INTEGER distance;
+	distance.QuadPart = 0;
+	SetFilePointerEx(hFile, distance, nullptr, FILE_BEGIN);
+#else
+	lseek(hFile, 0, SEEK_SET);
+#endif
+}
+
 void DirectoryFileHandle::Close()
 {
+	FlushWrites();
 	if (needsTrunc_ != -1) {
 #ifdef _WIN32
 		Seek((s32)needsTrunc_, FILEMOVE_BEGIN);
@@ -434,9 +512,86 @@ void DirectoryFileSystem::CloseAll() {
 		iter->second.hFile.Close();
 	}
 	entries.clear();
+	ClosePooledFiles();
+}
+
+void DirectoryFileSystem::ApplyFixedCase(std::string &path) {
+#if HOST_IS_CASE_SENSITIVE
+	auto it = fixedCase_.find(path);
+	if (it != fixedCase_.end()) {
+		path = it->second;
+		caseCacheHits_++;
+	}
+#endif
+}
+
+bool DirectoryFileSystem::TakePooledFile(const std::string &guestFilename, DirectoryFileHandle &hFile) {
+	for (auto it = pooledFiles_.begin(); it != pooledFiles_.end(); ++it) {
+		if (it->guestFilename == guestFilename) {
+			hFile = it->hFile;
+			hFile.Rewind();
+			pooledFiles_.erase(it);
+			filePoolHits_++;
+			return true;
+		}
+	}
+	return false;
+}
+
+void DirectoryFileSystem::PoolFile(const std::string &guestFilename, const DirectoryFileHandle &hFile) {
+	if (pooledFiles_.size() >= MAX_POOLED_FILES) {
+		pooledFiles_.back().hFile.Close();
+		pooledFiles_.pop_back();
+	}
+	PooledFile pooled;
+	pooled.guestFilename = guestFilename;
+	pooled.hFile = hFile;
+	pooledFiles_.insert(pooledFiles_.begin(), pooled);
+}
+
+void DirectoryFileSystem::ClosePooledFiles() {
+	for (auto &pooled : pooledFiles_) {
+		pooled.hFile.Close();
+	}
+	pooledFiles_.clear();
+}
+
+void DirectoryFileSystem::InvalidateHostCaches() {
+	FlushPendingWrites();
+	ClosePooledFiles();
+	fixedCase_.clear();
+}
+
+void DirectoryFileSystem::FlushPendingWrites() {
+	if (!(flags & FileSystemFlags::WRITE_BACK))
+		return;
+	for (auto &entry : entries) {
+		entry.second.hFile.FlushWrites();
+	}
+}
+
+void DirectoryFileSystem::FlushStaleWrites() {
+	if (!(flags & FileSystemFlags::WRITE_BACK))
+		return;
+	double now = time_now_d();
+	for (auto &entry : entries) {
+		entry.second.hFile.FlushWritesIfStale(now);
+	}
+}
+
+bool DirectoryFileSystem::WriteBackHasRoom() {
+	// Checking is a syscall, so only do it once in a while.
+	double now = time_now_d();
+	if (freeSpaceCheckTime_ < 0.0 || now - freeSpaceCheckTime_ >= WRITE_BACK_MAX_AGE) {
+		int64_t space = 0;
+		writeBackHasRoom_ = free_disk_space(basePath, space) && space >= WRITE_BACK_MIN_FREE;
+		freeSpaceCheckTime_ = now;
+	}
+	return writeBackHasRoom_;
 }
 
 bool DirectoryFileSystem::MkDir(const std::string &dirname) {
+	InvalidateHostCaches();
 	bool result;
 #if HOST_IS_CASE_SENSITIVE
 	// Must fix case BEFORE attempting, because MkDir would create
@@ -455,6 +610,7 @@ bool DirectoryFileSystem::MkDir(const std::string &dirname) {
 }
 
 bool DirectoryFileSystem::RmDir(const std::string &dirname) {
+	InvalidateHostCaches();
 	Path fullName = GetLocalPath(dirname);
 
 #if HOST_IS_CASE_SENSITIVE
@@ -478,6 +634,7 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 }
 
 int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &to) {
+	InvalidateHostCaches();
 	std::string fullTo = to;
 
 	// Rename ignores the path (even if specified) on to.
@@ -526,6 +683,7 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 }
 
 bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
+	InvalidateHostCaches();
 	Path localPath = GetLocalPath(filename);
 
 	bool retValue = File::Delete(localPath);
@@ -548,10 +706,30 @@ bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
 }
 
 int DirectoryFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename) {
+	FlushPendingWrites();
+	if (access & FILEACCESS_CREATE) {
+		InvalidateHostCaches();
+	} else if (access != FILEACCESS_READ) {
+		ClosePooledFiles();
+	}
+
 	OpenFileEntry entry;
 	entry.hFile.fileSystemFlags_ = flags;
 	u32 err = 0;
-	bool success = entry.hFile.Open(basePath, filename, access, err);
+	ApplyFixedCase(filename);
+	bool success;
+	if (access == FILEACCESS_READ && TakePooledFile(filename, entry.hFile)) {
+		success = true;
+	} else {
+#if HOST_IS_CASE_SENSITIVE
+		std::string requested = filename;
+		success = entry.hFile.Open(basePath, filename, access, err);
+		if (success && filename != requested)
+			fixedCase_[requested] = filename;
+#else
+		success = entry.hFile.Open(basePath, filename, access, err);
+#endif
+	}
 	if (err == 0 && !success) {
 		err = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
 	}
@@ -591,7 +769,14 @@ void DirectoryFileSystem::CloseFile(u32 handle) {
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
 		hAlloc->FreeHandle(handle);
-		iter->second.hFile.Close();
+#ifndef _WIN32
+		// Games often reopen the same files, so keep read-only ones around for a bit.
+		// Not on Windows, where an open handle would block the host from writing or deleting the file.
+		if (iter->second.access == FILEACCESS_READ)
+			PoolFile(iter->second.guestFilename, iter->second.hFile);
+		else
+#endif
+			iter->second.hFile.Close();
 		entries.erase(iter);
 	} else {
 		//This shouldn't happen...
@@ -625,6 +810,8 @@ size_t DirectoryFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &use
 			return 0;
 		}
 
+		// Another handle might have buffered writes to the same file.
+		FlushPendingWrites();
 		size_t bytesRead = iter->second.hFile.Read(pointer,size);
 		return bytesRead;
 	} else {
@@ -642,7 +829,16 @@ size_t DirectoryFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size) {
 size_t DirectoryFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, int &usec) {
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
-		size_t bytesWritten = iter->second.hFile.Write(pointer,size);
+		bool mayBuffer = false;
+		if (flags & FileSystemFlags::WRITE_BACK) {
+			// Keep writes to different files in the order the game made them.
+			for (auto &entry : entries) {
+				if (entry.first != handle)
+					entry.second.hFile.FlushWrites();
+			}
+			mayBuffer = WriteBackHasRoom();
+		}
+		size_t bytesWritten = iter->second.hFile.Write(pointer, size, mayBuffer);
 		return bytesWritten;
 	} else {
 		//This shouldn't happen...
@@ -666,6 +862,8 @@ PSPFileInfo DirectoryFileSystem::GetFileInfo(std::string filename) {
 	PSPFileInfo x;
 	x.name = filename;
 
+	FlushPendingWrites();
+	ApplyFixedCase(filename);
 	Path fullName = GetLocalPath(filename);
 	if (!File::Exists(fullName)) {
 #if HOST_IS_CASE_SENSITIVE
@@ -791,6 +989,7 @@ bool DirectoryFileSystem::ComputeRecursiveDirSizeIfFast(const std::string &path,
 }
 
 std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(std::string path) {
+	FlushPendingWrites();
 	std::vector<PSPFileInfo> myVector;
 
 	std::vector<File::FileInfo> files;
@@ -881,6 +1080,8 @@ void DirectoryFileSystem::DoState(PointerWrap &p) {
 	//     u32               seek position
 	//     s64               current truncate position (v2+ only)
 
+	FlushPendingWrites();
+
 	u32 num = (u32) entries.size();
 	Do(p, num);
 
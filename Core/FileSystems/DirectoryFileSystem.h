@@ -20,6 +20,9 @@
 // TODO: Remove the Windows-specific code, FILE is fine there too.
 
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/File/Path.h"
 #include "Core/FileSystems/FileSystem.h"
@@ -43,6 +46,10 @@ struct DirectoryFileHandle {
 	bool replay_ = true;
 	bool inGameDir_ = false;
 	FileSystemFlags fileSystemFlags_ = (FileSystemFlags)0;
+	// With FileSystemFlags::WRITE_BACK, small writes are collected here and written together.
+	bool writeBack_ = false;
+	std::vector<u8> pendingWrite_;
+	double pendingSince_ = 0.0;
 
 	DirectoryFileHandle() {}
 
@@ -52,8 +59,12 @@ struct DirectoryFileHandle {
 	Path GetLocalPath(const Path &basePath, std::string localpath) const;
 	bool Open(const Path &basePath, std::string &fileName, FileAccess access, u32 &err);
 	size_t Read(u8* pointer, s64 size);
-	size_t Write(const u8* pointer, s64 size);
+	size_t Write(const u8* pointer, s64 size, bool mayBuffer = true);
 	size_t Seek(s32 position, FileMove type);
+	void FlushWrites();
+	void FlushWritesIfStale(double now);
+	// Seeks back to the start without going through replays, used when reusing a handle.
+	void Rewind();
 	void Close();
 };
 
@@ -86,6 +97,10 @@ class DirectoryFileSystem : public IFileSystem {
 	u64 FreeSpace(const std::string &path) override;
 
 	bool ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) override;
+	void FlushStaleWrites() override;
+
+	int CaseCacheHits() const { return caseCacheHits_; }
+	int FilePoolHits() const { return filePoolHits_; }
 
 private:
 	struct OpenFileEntry {
@@ -94,13 +109,38 @@ class DirectoryFileSystem : public IFileSystem {
 		FileAccess access = FILEACCESS_NONE;
 	};
 
+	// A read-only file that was closed recently, kept open in case it's opened again.
+	struct PooledFile {
+		std::string guestFilename;
+		DirectoryFileHandle hFile;
+	};
+	enum { MAX_POOLED_FILES = 8 };
+
 	typedef std::map<u32, OpenFileEntry> EntryMap;
 	EntryMap entries;
 	Path basePath;
 	IHandleAllocator *hAlloc;
 	FileSystemFlags flags;
 
+	// Guest paths that needed case fixing on a case sensitive host, to their fixed path.
+	std::unordered_map<std::string, std::string> fixedCase_;
+	// Most recently closed first.
+	std::vector<PooledFile> pooledFiles_;
+	int caseCacheHits_ = 0;
+	int filePoolHits_ = 0;
+
 	Path GetLocalPath(std::string internalPath) const;
+	void ApplyFixedCase(std::string &path);
+	bool TakePooledFile(const std::string &guestFilename, DirectoryFileHandle &hFile);
+	void PoolFile(const std::string &guestFilename, const DirectoryFileHandle &hFile);
+	void ClosePooledFiles();
+	// Host files may change, so forget about fixed paths and pooled files.
+	void InvalidateHostCaches();
+	void FlushPendingWrites();
+	// Buffered writes can't report a full disk, so only buffer when there's room.
+	bool WriteBackHasRoom();
+	double freeSpaceCheckTime_ = -1.0;
+	bool writeBackHasRoom_ = false;
 };
 
 // VFSFileSystem: Ability to map in Android APK paths as well! Does not support all features, only meant for fonts.
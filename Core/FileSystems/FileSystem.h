@@ -64,6 +64,7 @@ enum class FileSystemFlags {
 	CARD = 4,
 	FLASH = 8,
 	STRIP_PSP = 16,
+	WRITE_BACK = 32,
 };
 ENUM_CLASS_BITOPS(FileSystemFlags);
 
@@ -137,6 +138,8 @@ class IFileSystem {
 	virtual FileSystemFlags Flags() = 0;
 	virtual u64      FreeSpace(const std::string &path) = 0;
 	virtual bool     ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) = 0;
+	// Writes out any buffered data that has waited too long. Only some file systems buffer.
+	virtual void     FlushStaleWrites() {}
 };
 
 
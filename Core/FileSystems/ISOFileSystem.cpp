@@ -511,36 +511,12 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 		}
 
 		// Okay, we have size and position, let's rock.
-		const int firstBlockOffset = positionOnIso & 2047;
-		const int firstBlockSize = firstBlockOffset == 0 ? 0 : (int)std::min(size, 2048LL - firstBlockOffset);
-		const int lastBlockSize = (size - firstBlockSize) & 2047;
-		const s64 middleSize = size - firstBlockSize - lastBlockSize;
-		u32 secNum = (u32)(positionOnIso / 2048);
-		u8 theSector[2048];
-
-		if ((middleSize & 2047) != 0) {
-			ERROR_LOG(FILESYS, "Remaining size should be aligned");
-		}
-
-		const u8 *const start = pointer;
-		if (firstBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
-			pointer += firstBlockSize;
-		}
-		if (middleSize > 0) {
-			const u32 sectors = (u32)(middleSize / 2048);
-			blockDevice->ReadBlocks(secNum, sectors, pointer);
-			secNum += sectors;
-			pointer += middleSize;
-		}
-		if (lastBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector, lastBlockSize);
-			pointer += lastBlockSize;
-		}
+		// The device reads straight into the destination, except for any partial sectors.
+		blockDevice->ReadBytes(positionOnIso, (size_t)size, pointer);
+		// The sector after the last one touched.
+		const u32 secNum = (u32)(size > 0 ? (positionOnIso + size + 2047) / 2048 : positionOnIso / 2048);
 
-		size_t totalBytes = pointer - start;
+		size_t totalBytes = (size_t)size;
 		if (abs((int)lastReadBlock_ - (int)secNum) > 100) {
 			// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
 			usec = 100000;
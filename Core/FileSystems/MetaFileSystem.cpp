@@ -614,6 +614,17 @@ u64 MetaFileSystem::FreeSpace(const std::string &path)
 		return 0;
 }
 
+void MetaFileSystem::FlushStaleWrites()
+{
+	// Called periodically from the emu thread, don't wait on a slow async read.
+	std::unique_lock<std::recursive_mutex> guard(lock, std::try_to_lock);
+	if (!guard.owns_lock())
+		return;
+	for (auto &mount : fileSystems) {
+		mount.system->FlushStaleWrites();
+	}
+}
+
 void MetaFileSystem::DoState(PointerWrap &p)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
@@ -127,6 +127,7 @@ class MetaFileSystem : public IHandleAllocator, public IFileSystem {
 	PSPDevType DevType(u32 handle) override;
 	FileSystemFlags Flags() override { return FileSystemFlags::NONE; }
 	u64  FreeSpace(const std::string &path) override;
+	void FlushStaleWrites() override;
 
 	// Convenience helper - returns < 0 on failure.
 	int ReadEntireFile(const std::string &filename, std::vector<u8> &data);
@@ -22,6 +22,7 @@
 #define _POSIX_THREAD_SAFE_FUNCTIONS 200112L
 #endif
 #endif
+#include <algorithm>
 #include <ctime>
 
 #include "Common/File/FileUtil.h"
@@ -57,6 +58,7 @@ VirtualDiscFileSystem::VirtualDiscFileSystem(IHandleAllocator *_hAlloc, const Pa
 }
 
 VirtualDiscFileSystem::~VirtualDiscFileSystem() {
+	CloseCachedDiscFiles();
 	for (auto iter = entries.begin(), end = entries.end(); iter != end; ++iter) {
 		if (iter->second.type != VFILETYPE_ISO) {
 			iter->second.Close();
@@ -155,6 +157,26 @@ void VirtualDiscFileSystem::LoadFileListIndex() {
 	}
 
 	fclose(f);
+	RebuildFileListLookups();
+}
+
+void VirtualDiscFileSystem::RebuildFileListLookups() {
+	fileListByName_.clear();
+	fileListByBlock_.clear();
+	for (int i = 0; i < (int)fileList.size(); i++) {
+		AddFileListLookups(i);
+	}
+}
+
+void VirtualDiscFileSystem::AddFileListLookups(int index) {
+	// Keep the first entry for a name, like a linear search would find.
+	fileListByName_.insert(std::make_pair(fileList[index].fileName, index));
+
+	// Usually appended in block order, so this is typically an insert at the end.
+	auto pos = std::upper_bound(fileListByBlock_.begin(), fileListByBlock_.end(), index, [&](int a, int b) {
+		return fileList[a].firstBlock < fileList[b].firstBlock;
+	});
+	fileListByBlock_.insert(pos, index);
 }
 
 void VirtualDiscFileSystem::DoState(PointerWrap &p)
@@ -182,6 +204,8 @@ void VirtualDiscFileSystem::DoState(PointerWrap &p)
 
 	if (p.mode == p.MODE_READ)
 	{
+		RebuildFileListLookups();
+		CloseCachedDiscFiles();
 		entries.clear();
 
 		for (int i = 0; i < entryCount; i++)
@@ -265,11 +289,9 @@ int VirtualDiscFileSystem::getFileListIndex(std::string &fileName)
 		normalized = fileName;
 	}
 
-	for (size_t i = 0; i < fileList.size(); i++)
-	{
-		if (fileList[i].fileName == normalized)
-			return (int)i;
-	}
+	auto known = fileListByName_.find(normalized);
+	if (known != fileListByName_.end())
+		return known->second;
 
 	// unknown file - add it
 	Path fullName = GetLocalPath(fileName);
@@ -296,30 +318,65 @@ int VirtualDiscFileSystem::getFileListIndex(std::string &fileName)
 	currentBlockIndex += (entry.totalSize+2047)/2048;
 
 	fileList.push_back(entry);
+	AddFileListLookups((int)fileList.size() - 1);
 
 	return (int)fileList.size()-1;
 }
 
 int VirtualDiscFileSystem::getFileListIndex(u32 accessBlock, u32 accessSize, bool blockMode)
 {
-	for (size_t i = 0; i < fileList.size(); i++)
+	// Find the last file starting at or before accessBlock, then step back in case files overlap.
+	auto pos = std::upper_bound(fileListByBlock_.begin(), fileListByBlock_.end(), accessBlock, [&](u32 block, int index) {
+		return block < fileList[index].firstBlock;
+	});
+	while (pos != fileListByBlock_.begin())
 	{
-		if (fileList[i].firstBlock <= accessBlock)
-		{
-			u32 sectorOffset = (accessBlock-fileList[i].firstBlock)*2048;
-			u32 totalFileSize = blockMode ? (fileList[i].totalSize+2047) & ~2047 : fileList[i].totalSize;
+		--pos;
+		const FileListEntry &entry = fileList[*pos];
+		u32 sectorOffset = (accessBlock-entry.firstBlock)*2048;
+		u32 totalFileSize = blockMode ? (entry.totalSize+2047) & ~2047 : entry.totalSize;
 
-			u32 endOffset = sectorOffset+accessSize;
-			if (endOffset <= totalFileSize)
-			{
-				return (int)i;
-			}
+		u32 endOffset = sectorOffset+accessSize;
+		if (endOffset <= totalFileSize)
+		{
+			return *pos;
 		}
 	}
 
 	return -1;
 }
 
+VirtualDiscFileSystem::OpenFileEntry *VirtualDiscFileSystem::OpenCachedDiscFile(int fileIndex) {
+	for (size_t i = 0; i < cachedDiscFiles_.size(); i++) {
+		if (cachedDiscFiles_[i].fileIndex == fileIndex) {
+			std::rotate(cachedDiscFiles_.begin(), cachedDiscFiles_.begin() + i, cachedDiscFiles_.begin() + i + 1);
+			return &cachedDiscFiles_[0].file;
+		}
+	}
+
+	OpenFileEntry temp(Flags());
+	if (fileList[fileIndex].handler != NULL) {
+		temp.handler = fileList[fileIndex].handler;
+	}
+	if (!temp.Open(basePath, fileList[fileIndex].fileName, FILEACCESS_READ)) {
+		return nullptr;
+	}
+
+	if (cachedDiscFiles_.size() >= MAX_CACHED_DISC_FILES) {
+		cachedDiscFiles_.back().file.Close();
+		cachedDiscFiles_.pop_back();
+	}
+	cachedDiscFiles_.insert(cachedDiscFiles_.begin(), CachedDiscFile{ fileIndex, temp });
+	return &cachedDiscFiles_[0].file;
+}
+
+void VirtualDiscFileSystem::CloseCachedDiscFiles() {
+	for (CachedDiscFile &cached : cachedDiscFiles_) {
+		cached.file.Close();
+	}
+	cachedDiscFiles_.clear();
+}
+
 int VirtualDiscFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename)
 {
 	OpenFileEntry entry(Flags());
@@ -461,8 +518,6 @@ size_t VirtualDiscFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &u
 		}
 
 		// it's the whole iso... it could reference any of the files on the disc.
-		// For now let's just open and close the files on demand. Can certainly be done
-		// better though
 		if (iter->second.type == VFILETYPE_ISO)
 		{
 			int fileIndex = getFileListIndex(iter->second.curOffset,size*2048,true);
@@ -472,13 +527,8 @@ size_t VirtualDiscFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &u
 				return 0;
 			}
 
-			OpenFileEntry temp(Flags());
-			if (fileList[fileIndex].handler != NULL) {
-				temp.handler = fileList[fileIndex].handler;
-			}
-			bool success = temp.Open(basePath, fileList[fileIndex].fileName, FILEACCESS_READ);
-
-			if (!success)
+			OpenFileEntry *file = OpenCachedDiscFile(fileIndex);
+			if (!file)
 			{
 				ERROR_LOG(FILESYS,"VirtualDiscFileSystem: Error opening file %s", fileList[fileIndex].fileName.c_str());
 				return 0;
@@ -487,21 +537,19 @@ size_t VirtualDiscFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &u
 			u32 startOffset = (iter->second.curOffset-fileList[fileIndex].firstBlock)*2048;
 			size_t bytesRead;
 
-			temp.Seek(startOffset, FILEMOVE_BEGIN);
+			file->Seek(startOffset, FILEMOVE_BEGIN);
 
 			u32 remainingSize = fileList[fileIndex].totalSize-startOffset;
 			if (remainingSize < size * 2048)
 			{
 				// the file doesn't fill the whole last sector
 				// read what's there and zero fill the rest like on a real disc
-				bytesRead = temp.Read(pointer, remainingSize);
+				bytesRead = file->Read(pointer, remainingSize);
 				memset(&pointer[bytesRead], 0, size * 2048 - bytesRead);
 			} else {
-				bytesRead = temp.Read(pointer, size * 2048);
+				bytesRead = file->Read(pointer, size * 2048);
 			}
 
-			temp.Close();
-
 			iter->second.curOffset += size;
 			// TODO: This probably isn't enough...
 			if (abs((int)lastReadBlock_ - (int)iter->second.curOffset) > 100) {
@@ -20,6 +20,9 @@
 // TODO: Remove the Windows-specific code, FILE is fine there too.
 
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/File/Path.h"
 #include "Core/FileSystems/FileSystem.h"
@@ -60,6 +63,8 @@ class VirtualDiscFileSystem: public IFileSystem {
 	int getFileListIndex(std::string &fileName);
 	int getFileListIndex(u32 accessBlock, u32 accessSize, bool blockMode = false);
 	Path GetLocalPath(std::string localpath);
+	void RebuildFileListLookups();
+	void AddFileListLookups(int index);
 
 	typedef void *HandlerLibrary;
 	typedef int HandlerHandle;
@@ -186,8 +191,22 @@ class VirtualDiscFileSystem: public IFileSystem {
 	};
 
 	std::vector<FileListEntry> fileList;
+	// Lookups into fileList: by name, and indexes sorted by firstBlock for sector reads.
+	std::unordered_map<std::string, int> fileListByName_;
+	std::vector<int> fileListByBlock_;
 	u32 currentBlockIndex;
 	u32 lastReadBlock_;
 
+	// Host files recently read through the whole-disc handle, most recently used first.
+	// Streaming reads tend to hit the same few files, so this avoids reopening them every read.
+	struct CachedDiscFile {
+		int fileIndex;
+		OpenFileEntry file;
+	};
+	enum { MAX_CACHED_DISC_FILES = 8 };
+	std::vector<CachedDiscFile> cachedDiscFiles_;
+	OpenFileEntry *OpenCachedDiscFile(int fileIndex);
+	void CloseCachedDiscFiles();
+
 	std::map<std::string, Handler *> handlers;
 };
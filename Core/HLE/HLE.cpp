@@ -15,13 +15,18 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <atomic>
 #include <cstdarg>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/BitScan.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
 #include "Common/Log.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/TimeUtil.h"
@@ -63,6 +68,25 @@ enum
 };
 
 static std::vector<HLEModule> moduleDB;
+// Index of each module's first function in syscallStats, so stats don't need a lookup.
+static std::vector<int> moduleStatsOffset;
+
+struct SyscallStatsEntry {
+	HLESyscallStats stats;
+	double frameTime;
+	u32 frameIndex;
+};
+static std::vector<SyscallStatsEntry> syscallStats;
+
+// Only written or resized from the emu thread, the position is atomic so dumping can tell what's stable.
+static std::vector<HLETraceRecord> syscallTrace;
+static std::atomic<u64> syscallTracePos;
+static bool syscallTraceEnabled = false;
+// Requested settings, applied by the emu thread on the next syscall.
+static std::mutex syscallTraceLock;
+static std::atomic<bool> syscallTraceDirty;
+static bool syscallTraceRequested = false;
+static size_t syscallTraceCapacity = 0;
 static int delayedResultEvent = -1;
 static int hleAfterSyscall = HLE_AFTER_NOTHING;
 static const char *hleAfterSyscallReschedReason;
@@ -156,6 +180,8 @@ void HLEShutdown() {
 	latestSyscall = nullptr;
 	latestSyscallPC = 0;
 	moduleDB.clear();
+	moduleStatsOffset.clear();
+	syscallStats.clear();
 	enqueuedMipsCalls.clear();
 	for (auto p : mipsCallActions) {
 		delete p;
@@ -167,6 +193,15 @@ void RegisterModule(const char *name, int numFunctions, const HLEFunction *funcT
 {
 	HLEModule module = {name, numFunctions, funcTable};
 	moduleDB.push_back(module);
+
+	moduleStatsOffset.push_back((int)syscallStats.size());
+	syscallStats.resize(syscallStats.size() + numFunctions);
+	for (int i = 0; i < numFunctions; ++i) {
+		SyscallStatsEntry &entry = syscallStats[moduleStatsOffset.back() + i];
+		entry = {};
+		entry.stats.module = name;
+		entry.stats.name = funcTable[i].name;
+	}
 }
 
 int GetModuleIndex(const char *moduleName)
@@ -589,11 +624,21 @@ inline void hleFinishSyscall(const HLEFunction &info)
 
 static void updateSyscallStats(int modulenum, int funcnum, double total)
 {
-	const char *name = moduleDB[modulenum].funcTable[funcnum].name;
+	SyscallStatsEntry &entry = syscallStats[moduleStatsOffset[modulenum] + funcnum];
+	const char *name = entry.stats.name;
 	// Ignore this one, especially for msInSyscalls (although that ignores CoreTiming events.)
 	if (0 == strcmp(name, "_sceKernelIdle"))
 		return;
 
+	HLESyscallStats &stats = entry.stats;
+	stats.calls++;
+	stats.totalTime += total;
+	if (total > stats.maxTime)
+		stats.maxTime = total;
+	u32 usec = total >= 4294.0 ? 0xFFFFFFFF : (u32)(total * 1000000.0);
+	u32 bucket = 32 - clz32(usec);
+	stats.histogram[std::min(bucket, (u32)HLE_SYSCALL_HISTOGRAM_BUCKETS - 1)]++;
+
 	if (total > kernelStats.slowestSyscallTime)
 	{
 		kernelStats.slowestSyscallTime = total;
@@ -601,26 +646,132 @@ static void updateSyscallStats(int modulenum, int funcnum, double total)
 	}
 	kernelStats.msInSyscalls += total;
 
-	KernelStatsSyscall statCall(modulenum, funcnum);
-	auto summedStat = kernelStats.summedMsInSyscalls.find(statCall);
-	if (summedStat == kernelStats.summedMsInSyscalls.end())
+	if (entry.frameIndex != kernelStats.frameIndex)
 	{
-		kernelStats.summedMsInSyscalls[statCall] = total;
-		if (total > kernelStats.summedSlowestSyscallTime)
-		{
-			kernelStats.summedSlowestSyscallTime = total;
-			kernelStats.summedSlowestSyscallName = name;
-		}
+		entry.frameIndex = kernelStats.frameIndex;
+		entry.frameTime = 0.0;
 	}
-	else
+	entry.frameTime += total;
+	if (entry.frameTime > kernelStats.summedSlowestSyscallTime)
 	{
-		double newTotal = kernelStats.summedMsInSyscalls[statCall] += total;
-		if (newTotal > kernelStats.summedSlowestSyscallTime)
-		{
-			kernelStats.summedSlowestSyscallTime = newTotal;
-			kernelStats.summedSlowestSyscallName = name;
+		kernelStats.summedSlowestSyscallTime = entry.frameTime;
+		kernelStats.summedSlowestSyscallName = name;
+	}
+}
+
+void hleGetSyscallStats(std::vector<HLESyscallStats> &stats) {
+	stats.clear();
+	for (const auto &entry : syscallStats) {
+		if (entry.stats.calls != 0)
+			stats.push_back(entry.stats);
+	}
+}
+
+void hleResetSyscallStats() {
+	for (auto &entry : syscallStats) {
+		entry.stats.calls = 0;
+		entry.stats.totalTime = 0.0;
+		entry.stats.maxTime = 0.0;
+		memset(entry.stats.histogram, 0, sizeof(entry.stats.histogram));
+	}
+}
+
+void hleSetSyscallTrace(bool enable, size_t capacity) {
+	std::lock_guard<std::mutex> guard(syscallTraceLock);
+	if (enable != syscallTraceRequested)
+		Core_ForceDebugStats(enable);
+	syscallTraceRequested = enable;
+	syscallTraceCapacity = enable ? capacity : 0;
+	syscallTraceDirty = true;
+}
+
+void hleClearSyscallTrace() {
+	std::lock_guard<std::mutex> guard(syscallTraceLock);
+	// The ring is emptied on the emu thread before the next syscall is recorded.
+	syscallTraceDirty = true;
+}
+
+static void applySyscallTraceSettings() {
+	std::lock_guard<std::mutex> guard(syscallTraceLock);
+	syscallTrace.clear();
+	syscallTrace.shrink_to_fit();
+	syscallTrace.resize(syscallTraceCapacity);
+	syscallTracePos = 0;
+	syscallTraceEnabled = syscallTraceRequested && syscallTraceCapacity != 0;
+	syscallTraceDirty = false;
+}
+
+static void recordSyscallTrace(u32 callno, u32 pc, const u32 *args, double total) {
+	u64 pos = syscallTracePos.load(std::memory_order_relaxed);
+	HLETraceRecord &rec = syscallTrace[pos % syscallTrace.size()];
+	rec.ticks = CoreTiming::GetTicks();
+	rec.callno = callno;
+	rec.pc = pc;
+	memcpy(rec.args, args, sizeof(rec.args));
+	rec.v0 = currentMIPS->r[MIPS_REG_V0];
+	rec.v1 = currentMIPS->r[MIPS_REG_V1];
+	rec.hostNanos = total >= 4.0 ? 0xFFFFFFFF : (u32)(total * 1000000000.0);
+	rec.reserved = 0;
+	syscallTracePos.store(pos + 1, std::memory_order_release);
+}
+
+// File layout, all little endian:
+//   char magic[4] = "PPHT", u32 version = 1, u32 sizeof(HLETraceRecord), u32 record count
+//   u32 module count, then per module: u32 function count, u8 length + name,
+//     then per function: u32 nid, u8 length + name
+//   records, oldest first.
+int hleDumpSyscallTrace(const Path &filename) {
+	std::lock_guard<std::mutex> guard(syscallTraceLock);
+	if (syscallTrace.empty())
+		return -1;
+
+	// Take a copy first, records that were overwritten while copying get dropped.
+	const u64 size = syscallTrace.size();
+	// A pending clear or resize hasn't been applied yet, so nothing in the ring is current.
+	u64 end = syscallTraceDirty ? 0 : syscallTracePos.load(std::memory_order_acquire);
+	u64 start = end > size ? end - size : 0;
+	std::vector<HLETraceRecord> records;
+	records.reserve((size_t)(end - start));
+	for (u64 i = start; i < end; ++i)
+		records.push_back(syscallTrace[i % size]);
+	// The slot for "after" may be in the middle of being written, so it's one more than a full ring.
+	u64 after = syscallTracePos.load(std::memory_order_acquire);
+	u64 firstValid = after >= size ? after - size + 1 : 0;
+	if (firstValid > start)
+		records.erase(records.begin(), records.begin() + (size_t)std::min(firstValid - start, (u64)records.size()));
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return -1;
+
+	auto writeU32 = [&](u32 v) {
+		fwrite(&v, sizeof(v), 1, f);
+	};
+	auto writeName = [&](const char *name) {
+		size_t len = std::min(strlen(name ? name : ""), (size_t)255);
+		u8 len8 = (u8)len;
+		fwrite(&len8, 1, 1, f);
+		fwrite(name, 1, len, f);
+	};
+
+	fwrite("PPHT", 1, 4, f);
+	writeU32(1);
+	writeU32((u32)sizeof(HLETraceRecord));
+	writeU32((u32)records.size());
+	writeU32((u32)moduleDB.size());
+	for (const HLEModule &module : moduleDB) {
+		writeU32((u32)module.numFunctions);
+		writeName(module.name);
+		for (int i = 0; i < module.numFunctions; ++i) {
+			writeU32(module.funcTable[i].ID);
+			writeName(module.funcTable[i].name);
 		}
 	}
+	if (!records.empty())
+		fwrite(&records[0], sizeof(HLETraceRecord), records.size(), f);
+	fclose(f);
+
+	return (int)records.size();
 }
 
 inline void CallSyscallWithFlags(const HLEFunction *info)
@@ -713,7 +864,15 @@ void CallSyscall(MIPSOpcode op)
 {
 	PROFILE_THIS_SCOPE("syscall");
 	double start = 0.0;  // need to initialize to fix the race condition where coreCollectDebugStats is enabled in the middle of this func.
+	u32 traceArgs[8];
+	u32 tracePC = 0;
 	if (coreCollectDebugStats) {
+		if (syscallTraceDirty)
+			applySyscallTraceSettings();
+		if (syscallTraceEnabled) {
+			memcpy(traceArgs, &currentMIPS->r[MIPS_REG_A0], sizeof(traceArgs));
+			tracePC = currentMIPS->pc;
+		}
 		start = time_now_d();
 	}
 
@@ -747,6 +906,8 @@ void CallSyscall(MIPSOpcode op)
 		hleSteppingTime = 0.0;
 		hleFlipTime = 0.0;
 		updateSyscallStats(modulenum, funcnum, total);
+		if (syscallTraceEnabled && tracePC != 0)
+			recordSyscallTrace(callno, tracePC, traceArgs, total);
 	}
 }
 
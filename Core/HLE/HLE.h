@@ -20,11 +20,13 @@
 #include <cstdio>
 #include <cstdarg>
 #include <type_traits>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
 #include "Core/MIPS/MIPS.h"
 
+class Path;
 class PointerWrap;
 class PSPAction;
 typedef void (* HLEFunc)();
@@ -157,6 +159,46 @@ const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op);
 // For jit, takes arg: const HLEFunction *
 void *GetQuickSyscallFunc(MIPSOpcode op);
 
+enum {
+	HLE_SYSCALL_HISTOGRAM_BUCKETS = 24,
+};
+
+// Collected per function while debug stats are on (see Core_UpdateDebugStats.)
+struct HLESyscallStats {
+	const char *module;
+	const char *name;
+	u64 calls;
+	double totalTime;
+	double maxTime;
+	// Bucket 0 is calls under 1us, bucket i is [2^(i-1), 2^i) us, the last bucket also has anything longer.
+	u32 histogram[HLE_SYSCALL_HISTOGRAM_BUCKETS];
+};
+
+// One record in the syscall trace ring, also the on disk format.
+struct HLETraceRecord {
+	u64 ticks;
+	// Same as in the syscall op: module << 12 | func.
+	u32 callno;
+	u32 pc;
+	// a0-a3, t0-t3.
+	u32 args[8];
+	u32 v0;
+	u32 v1;
+	// Host time spent in the call, in nanoseconds.
+	u32 hostNanos;
+	u32 reserved;
+};
+
+// Fills stats with every function called since the last reset, in no particular order.
+void hleGetSyscallStats(std::vector<HLESyscallStats> &stats);
+void hleResetSyscallStats();
+// Forces debug stats on while enabled.  With a capacity, the most recent syscalls are also kept in a ring.
+void hleSetSyscallTrace(bool enable, size_t capacity);
+// Drops all records from the trace ring, keeping the current settings.
+void hleClearSyscallTrace();
+// Writes the trace ring oldest first, see HLE.cpp for the file layout.  Returns the number of records, or -1.
+int hleDumpSyscallTrace(const Path &filename);
+
 void hleDoLogInternal(LogTypes::LOG_TYPE t, LogTypes::LOG_LEVELS level, u64 res, const char *file, int line, const char *reportTag, char retmask, const char *reason, const char *formatted_reason);
 
 template <typename T>
@@ -41,6 +41,7 @@
 #include "Core/Reporting.h"
 #include "Core/Core.h"
 #include "Core/System.h"
+#include "Core/FileSystems/MetaFileSystem.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/HLE/sceDisplay.h"
@@ -517,6 +518,11 @@ void hleEnterVblank(u64 userdata, int cyclesLate) {
 
 	numVBlanksSinceFlip++;
 
+	if (g_Config.bMemStickWriteBack) {
+		// Buffered memstick writes shouldn't sit around if the game stops writing.
+		pspFileSystem.FlushStaleWrites();
+	}
+
 	// TODO: Should this be done here or in hleLeaveVblank?
 	if (framebufIsLatched) {
 		DEBUG_LOG(SCEDISPLAY, "Setting latched framebuffer %08x (prev: %08x)", latchedFramebuf.topaddr, framebuf.topaddr);
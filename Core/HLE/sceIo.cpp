@@ -639,6 +639,9 @@ void __IoInit() {
 		INFO_LOG(SCEIO, "Enabling /PSP compatibility mode");
 		memstickFlags |= FileSystemFlags::STRIP_PSP;
 	}
+	if (g_Config.bMemStickWriteBack) {
+		memstickFlags |= FileSystemFlags::WRITE_BACK;
+	}
 
 	auto memstickSystem = std::shared_ptr<IFileSystem>(new DirectoryFileSystem(&pspFileSystem, g_Config.memStickDirectory, memstickFlags));
 
@@ -543,8 +543,6 @@ class KernelObjectPool {
 
 extern KernelObjectPool kernelObjects;
 
-typedef std::pair<int, int> KernelStatsSyscall;
-
 struct KernelStats {
 	void Reset() {
 		ResetFrame();
@@ -553,7 +551,8 @@ struct KernelStats {
 		msInSyscalls = 0;
 		slowestSyscallTime = 0;
 		slowestSyscallName = 0;
-		summedMsInSyscalls.clear();
+		// Invalidates the per frame totals in the HLE syscall stats.
+		frameIndex++;
 		summedSlowestSyscallTime = 0;
 		summedSlowestSyscallName = 0;
 	}
@@ -561,7 +560,7 @@ struct KernelStats {
 	double msInSyscalls;
 	double slowestSyscallTime;
 	const char *slowestSyscallName;
-	std::map<KernelStatsSyscall, double> summedMsInSyscalls;
+	u32 frameIndex;
 	double summedSlowestSyscallTime;
 	const char *summedSlowestSyscallName;
 };
@@ -26,6 +26,7 @@
 #include "Common/Serialize/SerializeSet.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/HLE/HLE.h"
@@ -1371,6 +1372,7 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 
 		// If the ELF has debug symbols, don't add entries to the symbol table.
 		bool insertSymbols = scan && !reader.LoadSymbols();
+		double scanStartTime = time_now_d();
 		std::vector<SectionID> codeSections = reader.GetCodeSections();
 		for (SectionID id : codeSections) {
 			u32 start = reader.GetSectionAddr(id);
@@ -1414,6 +1416,7 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		}
 
 		if (scan) {
+			INFO_LOG(LOADER, "Scanned module %s for functions in %0.2f ms", module->nm.name, (time_now_d() - scanStartTime) * 1000.0);
 			MIPSAnalyst::FinalizeScan(insertSymbols);
 		}
 	}
@@ -1907,6 +1910,13 @@ void __KernelGPUReplay() {
 	}
 
 	if (PSP_CoreParameter().headLess && !PSP_CoreParameter().startBreak) {
+		// When benchmarking, keep replaying every vblank until we have enough samples.
+		if (GPURecord::GetReplayBenchmarkRemaining() > 0)
+			return;
+		// Otherwise play each recorded frame once.
+		if (GPURecord::GetReplayFramesRemaining() > 0)
+			return;
+
 		PSPPointer<u8> topaddr;
 		u32 linesize = 512;
 		__DisplayGetFramebuf(&topaddr, &linesize, nullptr, 0);
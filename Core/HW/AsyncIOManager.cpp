@@ -39,6 +39,7 @@ bool AsyncIOManager::HasOperation(u32 handle) {
 }
 
 void AsyncIOManager::ScheduleOperation(AsyncIOEvent ev) {
+	ev.startTicks = CoreTiming::GetTicks();
 	{
 		std::lock_guard<std::mutex> guard(resultsLock_);
 		if (!resultsPending_.insert(ev.handle).second) {
@@ -116,11 +117,11 @@ u64 AsyncIOManager::ResultFinishTicks(u32 handle) {
 void AsyncIOManager::ProcessEvent(AsyncIOEvent ev) {
 	switch (ev.type) {
 	case IO_EVENT_READ:
-		Read(ev.handle, ev.buf, ev.bytes, ev.invalidateAddr);
+		Read(ev);
 		break;
 
 	case IO_EVENT_WRITE:
-		Write(ev.handle, ev.buf, ev.bytes);
+		Write(ev);
 		break;
 
 	default:
@@ -128,16 +129,16 @@ void AsyncIOManager::ProcessEvent(AsyncIOEvent ev) {
 	}
 }
 
-void AsyncIOManager::Read(u32 handle, u8 *buf, size_t bytes, u32 invalidateAddr) {
+void AsyncIOManager::Read(const AsyncIOEvent &ev) {
 	int usec = 0;
-	s64 result = pspFileSystem.ReadFile(handle, buf, bytes, usec);
-	EventResult(handle, AsyncIOResult(result, usec, invalidateAddr));
+	s64 result = pspFileSystem.ReadFile(ev.handle, ev.buf, ev.bytes, usec);
+	EventResult(ev.handle, AsyncIOResult(result, ev.startTicks, usec, ev.invalidateAddr));
 }
 
-void AsyncIOManager::Write(u32 handle, u8 *buf, size_t bytes) {
+void AsyncIOManager::Write(const AsyncIOEvent &ev) {
 	int usec = 0;
-	s64 result = pspFileSystem.WriteFile(handle, buf, bytes, usec);
-	EventResult(handle, AsyncIOResult(result, usec));
+	s64 result = pspFileSystem.WriteFile(ev.handle, ev.buf, ev.bytes, usec);
+	EventResult(ev.handle, AsyncIOResult(result, ev.startTicks, usec));
 }
 
 void AsyncIOManager::EventResult(u32 handle, AsyncIOResult result) {
@@ -39,6 +39,8 @@ struct AsyncIOEvent {
 	u8 *buf;
 	size_t bytes;
 	u32 invalidateAddr;
+	// Emulated time the operation was scheduled at, used to compute finishTicks.
+	u64 startTicks;
 
 	operator AsyncIOEventType() const {
 		return type;
@@ -52,8 +54,10 @@ struct AsyncIOResult {
 	explicit AsyncIOResult(s64 r) : result(r), finishTicks(0), invalidateAddr(0) {
 	}
 
-	AsyncIOResult(s64 r, int usec, u32 addr = 0) : result(r), invalidateAddr(addr) {
-		finishTicks = CoreTiming::GetTicks() + usToCycles(usec);
+	// Timing is relative to when the operation was scheduled on the emu thread, not when the host
+	// finished it, so it doesn't depend on how fast the IO thread happened to be.
+	AsyncIOResult(s64 r, u64 startTicks, int usec, u32 addr = 0) : result(r), invalidateAddr(addr) {
+		finishTicks = startTicks + usToCycles(usec);
 	}
 
 	void DoState(PointerWrap &p) {
@@ -97,8 +101,8 @@ class AsyncIOManager : public IOThreadEventQueue {
 private:
 	bool PopResult(u32 handle, AsyncIOResult &result);
 	bool ReadResult(u32 handle, AsyncIOResult &result);
-	void Read(u32 handle, u8 *buf, size_t bytes, u32 invalidateAddr);
-	void Write(u32 handle, u8 *buf, size_t bytes);
+	void Read(const AsyncIOEvent &ev);
+	void Write(const AsyncIOEvent &ev);
 
 	void EventResult(u32 handle, AsyncIOResult result);
 
@@ -127,6 +127,26 @@ struct BufferQueue {
 		return bytesgot;
 	}
 
+	// Like get_front, but skips offset bytes first.  Used to read ahead without consuming.
+	int get_at(int offset, unsigned char *buf, int wantedsize) {
+		if (wantedsize <= 0 || offset < 0 || offset >= getQueueSize())
+			return 0;
+		int bytesgot = getQueueSize() - offset;
+		if (wantedsize < bytesgot)
+			bytesgot = wantedsize;
+		int pos = start + offset;
+		if (pos >= bufQueueSize)
+			pos -= bufQueueSize;
+		int firstSize = bufQueueSize - pos;
+		if (bytesgot <= firstSize) {
+			memcpy(buf, bufQueue + pos, bytesgot);
+		} else {
+			memcpy(buf, bufQueue + pos, firstSize);
+			memcpy(buf + firstSize, bufQueue, bytesgot - firstSize);
+		}
+		return bytesgot;
+	}
+
 	void DoState(PointerWrap &p);
 
 private:
@@ -16,6 +16,7 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Core/Config.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HW/MediaEngine.h"
@@ -174,6 +175,16 @@ void MediaEngine::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+	// The decode-ahead worker only peeks at m_pdata, so the saved state is the same as without it.
+	std::unique_lock<std::mutex> aheadGuard(m_aheadLock, std::defer_lock);
+	if (p.mode == p.MODE_READ) {
+#ifdef USE_FFMPEG
+		stopDecodeAhead(false);
+#endif
+	} else {
+		aheadGuard.lock();
+	}
+
 	Do(p, m_videoStream);
 	Do(p, m_audioStream);
 
@@ -246,6 +257,8 @@ static int MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size) {
 		size = std::min(buf_size, mpeg->m_mpegheaderSize - mpeg->m_mpegheaderReadPos);
 		memcpy(buf, mpeg->m_mpegheader + mpeg->m_mpegheaderReadPos, size);
 		mpeg->m_mpegheaderReadPos += size;
+	} else if (mpeg->m_aheadRunning) {
+		size = mpeg->readAheadData(buf, buf_size);
 	} else {
 		size = mpeg->m_pdata->pop_front(buf, buf_size);
 		if (size > 0)
@@ -362,6 +375,11 @@ bool MediaEngine::openContext(bool keepReadPos) {
 void MediaEngine::closeContext()
 {
 #ifdef USE_FFMPEG
+	stopDecodeAhead(false);
+	sws_freeContext(m_aheadSwsCtx);
+	m_aheadSwsCtx = nullptr;
+	m_aheadSwsFmt = -1;
+
 	if (m_buffer)
 		av_free(m_buffer);
 	if (m_pFrameRGB)
@@ -452,8 +470,11 @@ bool MediaEngine::addVideoStream(int streamNum, int streamId) {
 int MediaEngine::addStreamData(const u8 *buffer, int addSize) {
 	int size = addSize;
 	if (size > 0 && m_pdata) {
+		std::unique_lock<std::mutex> aheadGuard(m_aheadLock);
 		if (!m_pdata->push(buffer, size)) 
 			size  = 0;
+		m_aheadCond.notify_all();
+		aheadGuard.unlock();
 		if (m_demux) {
 			m_demux->addStreamData(buffer, addSize);
 		}
@@ -513,6 +534,9 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 	}
 
 #ifdef USE_FFMPEG
+	// The worker is decoding the old stream, and we're about to change the codecs.
+	stopDecodeAhead(true);
+
 	if (m_pFormatCtx && m_pCodecCtxs.find(streamNum) == m_pCodecCtxs.end()) {
 		// Get a pointer to the codec context for the video stream
 		if ((u32)streamNum >= m_pFormatCtx->nb_streams) {
@@ -652,22 +676,15 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 #endif
 }
 
-bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #ifdef USE_FFMPEG
-	auto codecIter = m_pCodecCtxs.find(m_videoStream);
-	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
-
-	if (!m_pFormatCtx)
-		return false;
-	if (!m_pCodecCtx)
-		return false;
-	if (!m_pFrame)
-		return false;
-
+// Reads and decodes packets until a frame of the selected video stream is ready.
+// hitEnd is set when the data ran out, and videoEnd then says if the stream is really over.
+bool MediaEngine::decodeFrame(AVCodecContext *codecCtx, AVFrame *frame, bool *hitEnd, bool *videoEnd) {
 	AVPacket packet;
 	av_init_packet(&packet);
 	int frameFinished;
 	bool bGetFrame = false;
+	*hitEnd = false;
 	while (!bGetFrame) {
 		bool dataEnd = av_read_frame(m_pFormatCtx, &packet) < 0;
 		// Even if we've read all frames, some may have been re-ordered frames at the end.
@@ -684,10 +701,10 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
 			if (packet.size != 0)
-				avcodec_send_packet(m_pCodecCtx, &packet);
-			int result = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
+				avcodec_send_packet(codecCtx, &packet);
+			int result = avcodec_receive_frame(codecCtx, frame);
 			if (result == 0) {
-				result = m_pFrame->pkt_size;
+				result = frame->pkt_size;
 				frameFinished = 1;
 			} else if (result == AVERROR(EAGAIN)) {
 				result = 0;
@@ -696,52 +713,16 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				frameFinished = 0;
 			}
 #else
-			int result = avcodec_decode_video2(m_pCodecCtx, m_pFrame, &frameFinished, &packet);
+			int result = avcodec_decode_video2(codecCtx, frame, &frameFinished, &packet);
 #endif
 			if (frameFinished) {
-				if (!m_pFrameRGB) {
-					setVideoDim();
-				}
-				if (m_pFrameRGB && !skipFrame) {
-					updateSwsFormat(videoPixelMode);
-					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
-					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
-					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
-
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
-						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-				}
-
-#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
-				int64_t bestPts = m_pFrame->best_effort_timestamp;
-				int64_t ptsDuration = m_pFrame->pkt_duration;
-#else
-				int64_t bestPts = av_frame_get_best_effort_timestamp(m_pFrame);
-				int64_t ptsDuration = av_frame_get_pkt_duration(m_pFrame);
-#endif
-				if (ptsDuration == 0) {
-					if (m_lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
-						// TODO: Assuming 29.97 if missing.
-						m_videopts += 3003;
-					} else {
-						m_videopts = bestPts - m_firstTimeStamp;
-						m_lastPts = m_videopts;
-					}
-				} else if (bestPts != AV_NOPTS_VALUE) {
-					m_videopts = bestPts + ptsDuration - m_firstTimeStamp;
-					m_lastPts = m_videopts;
-				} else {
-					m_videopts += ptsDuration;
-					m_lastPts = m_videopts;
-				}
 				bGetFrame = true;
 			}
 			if (result <= 0 && dataEnd) {
 				// Sometimes, m_readSize is less than m_streamSize at the end, but not by much.
 				// This is kinda a hack, but the ringbuffer would have to be prematurely empty too.
-				m_isVideoEnd = !bGetFrame && (m_pdata->getQueueSize() == 0);
-				if (m_isVideoEnd)
-					m_decodingsize = 0;
+				*hitEnd = true;
+				*videoEnd = !bGetFrame && pendingQueueSize() == 0;
 				break;
 			}
 		}
@@ -752,6 +733,93 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #endif
 	}
 	return bGetFrame;
+}
+
+void MediaEngine::updateVideoPts(const AVFrame *frame, s64 &videopts, s64 &lastPts) {
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
+	int64_t bestPts = frame->best_effort_timestamp;
+	int64_t ptsDuration = frame->pkt_duration;
+#else
+	int64_t bestPts = av_frame_get_best_effort_timestamp(frame);
+	int64_t ptsDuration = av_frame_get_pkt_duration(frame);
+#endif
+	if (ptsDuration == 0) {
+		if (lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
+			// TODO: Assuming 29.97 if missing.
+			videopts += 3003;
+		} else {
+			videopts = bestPts - m_firstTimeStamp;
+			lastPts = videopts;
+		}
+	} else if (bestPts != AV_NOPTS_VALUE) {
+		videopts = bestPts + ptsDuration - m_firstTimeStamp;
+		lastPts = videopts;
+	} else {
+		videopts += ptsDuration;
+		lastPts = videopts;
+	}
+}
+
+int MediaEngine::pendingQueueSize() {
+	if (!m_aheadRunning)
+		return m_pdata->getQueueSize();
+	std::lock_guard<std::mutex> guard(m_aheadLock);
+	return m_pdata->getQueueSize() - m_aheadCursor;
+}
+#endif
+
+void MediaEngine::convertFrame(int videoPixelMode) {
+#ifdef USE_FFMPEG
+	auto codecIter = m_pCodecCtxs.find(m_videoStream);
+	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
+	if (!m_pCodecCtx || !m_pFrameRGB)
+		return;
+
+	updateSwsFormat(videoPixelMode);
+	// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
+	// Update the linesize for the new format too.  We started with the largest size, so it should fit.
+	m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+
+	sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
+		m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+#endif
+}
+
+bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
+#ifdef USE_FFMPEG
+	auto codecIter = m_pCodecCtxs.find(m_videoStream);
+	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
+
+	if (!m_pFormatCtx)
+		return false;
+	if (!m_pCodecCtx)
+		return false;
+	if (!m_pFrame)
+		return false;
+
+	if (g_Config.iVideoDecodeAhead > 0)
+		return stepVideoAhead(videoPixelMode, skipFrame);
+	// Could've been turned off while running.
+	stopDecodeAhead(true);
+
+	bool hitEnd = false;
+	bool videoEnd = false;
+	bool bGetFrame = decodeFrame(m_pCodecCtx, m_pFrame, &hitEnd, &videoEnd);
+	if (bGetFrame) {
+		if (!m_pFrameRGB) {
+			setVideoDim();
+		}
+		if (m_pFrameRGB && !skipFrame) {
+			convertFrame(videoPixelMode);
+		}
+		updateVideoPts(m_pFrame, m_videopts, m_lastPts);
+	}
+	if (hitEnd) {
+		m_isVideoEnd = videoEnd;
+		if (m_isVideoEnd)
+			m_decodingsize = 0;
+	}
+	return bGetFrame;
 #else
 	// If video engine is not available, just add to the timestamp at least.
 	m_videopts += 3003;
@@ -759,6 +827,201 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #endif // USE_FFMPEG
 }
 
+#ifdef USE_FFMPEG
+
+void MediaEngine::startDecodeAhead() {
+	if (m_aheadThread.joinable())
+		return;
+
+	int depth = std::min(std::max(g_Config.iVideoDecodeAhead, 1), 8);
+	m_aheadSlots.resize(depth);
+	m_aheadHead = 0;
+	m_aheadCount = 0;
+	m_aheadCursor = 0;
+	m_aheadDecodingSize = m_decodingsize;
+	m_aheadVideopts = m_videopts;
+	m_aheadLastPts = m_lastPts;
+	m_aheadStop = false;
+	m_aheadDemand = false;
+	m_aheadRunning = true;
+	m_aheadThread = std::thread([this] {
+		SetCurrentThreadName("MediaDecodeAhead");
+		decodeAheadThread();
+	});
+}
+
+void MediaEngine::stopDecodeAhead(bool consumeRead) {
+	if (!m_aheadThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(m_aheadLock);
+		m_aheadStop = true;
+		// Let a pending read finish with whatever data there is, like a synchronous decode would.
+		m_aheadDemand = true;
+		m_aheadCond.notify_all();
+	}
+	m_aheadThread.join();
+	m_aheadRunning = false;
+	m_aheadStop = false;
+	m_aheadDemand = false;
+
+	// The demuxer has already seen this data, so it can't be fed again.
+	if (consumeRead && m_pdata)
+		m_pdata->pop_front(nullptr, m_aheadCursor);
+	m_aheadCursor = 0;
+	m_aheadHead = 0;
+	m_aheadCount = 0;
+
+	for (auto &slot : m_aheadSlots) {
+		if (slot.frame)
+			av_frame_free(&slot.frame);
+		if (slot.rgb)
+			av_free(slot.rgb);
+	}
+	m_aheadSlots.clear();
+}
+
+void MediaEngine::decodeAheadThread() {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	while (!m_aheadStop) {
+		if (m_aheadCount >= (int)m_aheadSlots.size()) {
+			m_aheadCond.wait(guard);
+			continue;
+		}
+
+		MediaAheadFrame &slot = m_aheadSlots[(m_aheadHead + m_aheadCount) % m_aheadSlots.size()];
+		int videoPixelMode = m_aheadPixelMode;
+		m_aheadFrameBytes = 0;
+		guard.unlock();
+
+		decodeAheadFrame(slot, videoPixelMode);
+
+		guard.lock();
+		slot.consumedBytes = m_aheadFrameBytes;
+		slot.decodingsize = m_aheadDecodingSize;
+		m_aheadCount++;
+		// The demand is met, don't let the next frame's reads run dry before the game wakes up.
+		m_aheadDemand = false;
+		m_aheadCond.notify_all();
+	}
+}
+
+void MediaEngine::decodeAheadFrame(MediaAheadFrame &slot, int videoPixelMode) {
+	// The codec contexts don't change while we're running, see setVideoStream().
+	AVCodecContext *codecCtx = m_pCodecCtxs.find(m_videoStream)->second;
+	if (!slot.frame)
+		slot.frame = av_frame_alloc();
+
+	slot.gotFrame = decodeFrame(codecCtx, slot.frame, &slot.hitEnd, &slot.videoEnd);
+	if (slot.hitEnd && slot.videoEnd)
+		m_aheadDecodingSize = 0;
+	if (!slot.gotFrame)
+		return;
+
+	updateVideoPts(slot.frame, m_aheadVideopts, m_aheadLastPts);
+	slot.videopts = m_aheadVideopts;
+	slot.lastPts = m_aheadLastPts;
+
+	// Convert at the codec size, which is what setVideoDim() picks.
+	int width = codecCtx->width;
+	int height = codecCtx->height;
+	int size = av_image_get_buffer_size(AV_PIX_FMT_RGBA, width, height, 1);
+	if (width <= 0 || height <= 0 || size <= 0) {
+		slot.pixelMode = -1;
+		return;
+	}
+	if (slot.rgbSize != size) {
+		av_free(slot.rgb);
+		slot.rgb = (u8 *)av_malloc(size);
+		slot.rgbSize = size;
+	}
+
+	AVPixelFormat swsDesired = getSwsFormat(videoPixelMode);
+	SwsContext *prevCtx = m_aheadSwsCtx;
+	m_aheadSwsCtx = sws_getCachedContext(m_aheadSwsCtx, width, height, codecCtx->pix_fmt, width, height, swsDesired, SWS_BILINEAR, nullptr, nullptr, nullptr);
+	if (prevCtx != m_aheadSwsCtx || m_aheadSwsFmt != swsDesired) {
+		m_aheadSwsFmt = swsDesired;
+
+		int *inv_coefficients;
+		int *coefficients;
+		int srcRange, dstRange;
+		int brightness, contrast, saturation;
+		if (sws_getColorspaceDetails(m_aheadSwsCtx, &inv_coefficients, &srcRange, &coefficients, &dstRange, &brightness, &contrast, &saturation) != -1) {
+			srcRange = 0;
+			dstRange = 0;
+			sws_setColorspaceDetails(m_aheadSwsCtx, inv_coefficients, srcRange, coefficients, dstRange, brightness, contrast, saturation);
+		}
+	}
+
+	uint8_t *dstData[4] = { slot.rgb };
+	int dstLinesize[4] = { getPixelFormatBytes(videoPixelMode) * width };
+	sws_scale(m_aheadSwsCtx, slot.frame->data, slot.frame->linesize, 0, height, dstData, dstLinesize);
+	slot.width = width;
+	slot.height = height;
+	slot.pixelMode = videoPixelMode;
+}
+
+bool MediaEngine::stepVideoAhead(int videoPixelMode, bool skipFrame) {
+	startDecodeAhead();
+
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	m_aheadPixelMode = videoPixelMode;
+	m_aheadDemand = true;
+	m_aheadCond.notify_all();
+	m_aheadCond.wait(guard, [this] { return m_aheadCount > 0; });
+	m_aheadDemand = false;
+
+	MediaAheadFrame &slot = m_aheadSlots[m_aheadHead];
+	m_pdata->pop_front(nullptr, slot.consumedBytes);
+	m_aheadCursor -= slot.consumedBytes;
+	m_decodingsize = slot.decodingsize;
+	if (slot.hitEnd)
+		m_isVideoEnd = slot.videoEnd;
+
+	bool bGetFrame = slot.gotFrame;
+	if (bGetFrame) {
+		av_frame_unref(m_pFrame);
+		av_frame_move_ref(m_pFrame, slot.frame);
+		if (!m_pFrameRGB) {
+			setVideoDim();
+		}
+		if (m_pFrameRGB && !skipFrame) {
+			if (slot.pixelMode == videoPixelMode && slot.width == m_desWidth && slot.height == m_desHeight) {
+				// Both were allocated for the 32-bit size, so we can just trade buffers.
+				std::swap(slot.rgb, m_buffer);
+				m_pFrameRGB->data[0] = m_buffer;
+				m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+			} else {
+				// The game switched formats under us, so convert again.
+				convertFrame(videoPixelMode);
+			}
+		}
+		m_videopts = slot.videopts;
+		m_lastPts = slot.lastPts;
+	}
+
+	m_aheadHead = (m_aheadHead + 1) % (int)m_aheadSlots.size();
+	m_aheadCount--;
+	m_aheadCond.notify_all();
+	return bGetFrame;
+}
+#endif
+
+int MediaEngine::readAheadData(u8 *buf, int size) {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	// Waiting here instead of returning 0 keeps FFmpeg from hitting a premature end of data.
+	m_aheadCond.wait(guard, [this] {
+		return MediaAheadCanRead(m_aheadStop, m_aheadDemand, m_aheadCount, m_pdata->getQueueSize(), m_aheadCursor);
+	});
+	int got = m_pdata->get_at(m_aheadCursor, buf, size);
+	m_aheadCursor += got;
+	m_aheadFrameBytes += got;
+	if (got > 0)
+		m_aheadDecodingSize = got;
+	return got;
+}
+
 // Helpers that null out alpha (which seems to be the case on the PSP.)
 // Some games depend on this, for example Sword Art Online (doesn't clear A's from buffer.)
 inline void writeVideoLineRGBA(void *destp, const void *srcp, int width) {
@@ -24,7 +24,12 @@
 
 // An approximation of what the interface will look like. Similar to JPCSP's.
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/HLE/sceMpeg.h"
 #include "Core/HW/MpegDemux.h"
@@ -50,6 +55,34 @@ inline s64 getMpegTimeStamp(const u8 *buf) {
 bool InitFFmpeg();
 #endif
 
+// A frame decoded ahead of time by MediaEngine's decode-ahead worker.
+struct MediaAheadFrame {
+#ifdef USE_FFMPEG
+	AVFrame *frame = nullptr;
+#endif
+	u8 *rgb = nullptr;
+	int rgbSize = 0;
+	int width = 0;
+	int height = 0;
+	int pixelMode = -1;
+	bool gotFrame = false;
+	bool hitEnd = false;
+	bool videoEnd = false;
+	s64 videopts = 0;
+	s64 lastPts = -1;
+	// How much of the ringbuffer was read to produce this frame.
+	int consumedBytes = 0;
+	int decodingsize = 0;
+};
+
+// Whether a decode-ahead read should go ahead now, instead of waiting for the game to add data.
+// Running dry only counts as the end of data if the game is waiting and no frame is ready for it.
+inline bool MediaAheadCanRead(bool stopping, bool demand, int framesReady, int queuedBytes, int cursor) {
+	if (stopping || queuedBytes > cursor)
+		return true;
+	return demand && framesReady == 0;
+}
+
 class MediaEngine
 {
 public:
@@ -98,8 +131,25 @@ class MediaEngine
 	bool SetupStreams();
 	bool setVideoDim(int width = 0, int height = 0);
 	void updateSwsFormat(int videoPixelMode);
+	void convertFrame(int videoPixelMode);
 	int getNextAudioFrame(u8 **buf, int *headerCode1, int *headerCode2);
 
+#ifdef USE_FFMPEG
+	bool decodeFrame(AVCodecContext *codecCtx, AVFrame *frame, bool *hitEnd, bool *videoEnd);
+	void updateVideoPts(const AVFrame *frame, s64 &videopts, s64 &lastPts);
+	int pendingQueueSize();
+
+	// Decode-ahead: a worker decodes and converts frames into a small pool while the game
+	// is busy, so stepVideo() only has to hand over a ready frame.
+	// The ringbuffer is only peeked by the worker, and consumed when a frame is handed over,
+	// so what the game sees (remain size, pts, end of video) matches decoding synchronously.
+	bool stepVideoAhead(int videoPixelMode, bool skipFrame);
+	void startDecodeAhead();
+	void stopDecodeAhead(bool consumeRead);
+	void decodeAheadThread();
+	void decodeAheadFrame(MediaAheadFrame &slot, int videoPixelMode);
+#endif
+
 public:  // TODO: Very little of this below should be public.
 
 	// Video ffmpeg context - not used for audio
@@ -144,4 +194,30 @@ class MediaEngine
 
 	// used for audio type 
 	int m_audioType;
+
+	// Called by the read callback on the decode-ahead thread.
+	int readAheadData(u8 *buf, int size);
+
+	std::thread m_aheadThread;
+	std::mutex m_aheadLock;
+	std::condition_variable m_aheadCond;
+	std::vector<MediaAheadFrame> m_aheadSlots;
+	// Only true while m_aheadThread owns the format context.
+	bool m_aheadRunning = false;
+	bool m_aheadStop = false;
+	// The emulator is waiting for a frame, so reads must not wait for more data.
+	bool m_aheadDemand = false;
+	int m_aheadHead = 0;
+	int m_aheadCount = 0;
+	// Bytes of m_pdata already read by the worker, but not yet consumed.
+	int m_aheadCursor = 0;
+	int m_aheadFrameBytes = 0;
+	int m_aheadDecodingSize = 0;
+	int m_aheadPixelMode = 3;
+	s64 m_aheadVideopts = 0;
+	s64 m_aheadLastPts = -1;
+#ifdef USE_FFMPEG
+	SwsContext *m_aheadSwsCtx = nullptr;
+	int m_aheadSwsFmt = -1;
+#endif
 };
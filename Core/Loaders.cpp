@@ -44,7 +44,8 @@ FileLoader *ConstructFileLoader(const Path &filename) {
 	if (filename.Type() == PathType::HTTP) {
 		FileLoader *baseLoader = new RetryingFileLoader(new HTTPFileLoader(filename));
 		// For headless, avoid disk caching since it's usually used for tests that might mutate.
-		if (!PSP_CoreParameter().headLess) {
+		// Unless it was asked to share a cache with other instances.
+		if (!PSP_CoreParameter().headLess || DiskCachingFileLoaderCache::IsShared()) {
 			baseLoader = new DiskCachingFileLoader(baseLoader);
 		}
 		return new CachingFileLoader(baseLoader);
@@ -82,6 +82,16 @@ class FileLoader {
 		return ReadAt(absolutePos, 1, bytes, data, flags);
 	}
 
+	// Returns a pointer directly into the file's contents if the whole range is memory mapped,
+	// so callers can copy straight out of it.  Returns nullptr if not mapped (the default.)
+	// Note that a host I/O error while copying (like removable media going away, or the file being
+	// truncated) won't fail the read: it raises SIGBUS, or an in-page exception on Windows.
+	virtual const u8 *MappedData(s64 absolutePos, size_t bytes) {
+		return nullptr;
+	}
+	// Hint that a range will be read soon.  Only meaningful for mapped files, and not on Windows.
+	virtual void Prefetch(s64 absolutePos, size_t bytes) {}
+
 	// Cancel any operations that might block, if possible.
 	virtual void Cancel() {}
 
@@ -128,6 +138,12 @@ class ProxiedFileLoader : public FileLoader {
 	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override {
 		return backend_->ReadAt(absolutePos, bytes, data, flags);
 	}
+	const u8 *MappedData(s64 absolutePos, size_t bytes) override {
+		return backend_->MappedData(absolutePos, bytes);
+	}
+	void Prefetch(s64 absolutePos, size_t bytes) override {
+		backend_->Prefetch(absolutePos, bytes);
+	}
 
 protected:
 	FileLoader *backend_;
@@ -31,14 +31,15 @@
 
 namespace MIPSComp {
 
-IRFrontend::IRFrontend(bool startDefaultPrefix) {
+IRFrontend::IRFrontend(bool startDefaultPrefix, bool resetSkipFirst) {
 	js.startDefaultPrefix = true;
 	js.hasSetRounding = false;
 	// js.currentRoundingFunc = convertS0ToSCRATCH1[0];
 
 	// The debugger sets this so that "go" on a breakpoint will actually... go.
 	// But if they reset, we can end up hitting it by mistake, since it's based on PC and ticks.
-	CBreakPoints::SetSkipFirst(0);
+	if (resetSkipFirst)
+		CBreakPoints::SetSkipFirst(0);
 }
 
 void IRFrontend::DoState(PointerWrap &p) {
@@ -10,7 +10,8 @@ namespace MIPSComp {
 
 class IRFrontend : public MIPSFrontendInterface {
 public:
-	IRFrontend(bool startDefaultPrefix);
+	// Extra frontends used only for translating (like on worker threads) must not touch debugger state.
+	IRFrontend(bool startDefaultPrefix, bool resetSkipFirst = true);
 	void Comp_Generic(MIPSOpcode op) override;
 
 	void Comp_RunBlock(MIPSOpcode op) override;
@@ -98,6 +99,20 @@ class IRFrontend : public MIPSFrontendInterface {
 		opts = o;
 	}
 
+	// For extra frontends translating in parallel.  Rounding usage must be reported back afterward.
+	void CopySettingsFrom(const IRFrontend &other) {
+		js.startDefaultPrefix = other.js.startDefaultPrefix;
+		js.hasSetRounding = other.js.hasSetRounding;
+		js.lastSetRounding = other.js.lastSetRounding;
+		opts = other.opts;
+	}
+	bool HasSetRounding() const {
+		return js.hasSetRounding;
+	}
+	void MarkSetRounding() {
+		js.hasSetRounding = true;
+	}
+
 private:
 	void RestoreRoundingMode(bool force = false);
 	void ApplyRoundingMode(bool force = false);
@@ -15,10 +15,12 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <atomic>
 #include <set>
 
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
@@ -54,6 +56,7 @@ IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), m
 }
 
 IRJit::~IRJit() {
+	LogPreloadStats();
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -65,9 +68,17 @@ void IRJit::UpdateFCR31() {
 
 void IRJit::ClearCache() {
 	INFO_LOG(JIT, "IRJit: Clearing the cache!");
+	LogPreloadStats();
 	blocks_.Clear();
 }
 
+void IRJit::LogPreloadStats() {
+	if (preloadHits_ != 0) {
+		INFO_LOG(JIT, "IRJit: %d block compiles avoided by precompiling", preloadHits_);
+		preloadHits_ = 0;
+	}
+}
+
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
 	blocks_.InvalidateICache(em_address, length);
 }
@@ -84,6 +95,7 @@ void IRJit::Compile(u32 em_address) {
 			b->Finalize(block_num);
 			if (b->IsValid()) {
 				// Success, we're done.
+				preloadHits_++;
 				return;
 			}
 		}
@@ -113,6 +125,10 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 		return preload;
 	}
 
+	return AddBlock(em_address, instructions, mipsBytes, preload);
+}
+
+bool IRJit::AddBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload) {
 	int block_num = blocks_.AllocateBlock(em_address);
 	if ((block_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
 		// Out of block numbers.  Caller will handle.
@@ -135,9 +151,14 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	return true;
 }
 
-void IRJit::CompileFunction(u32 start_address, u32 length) {
-	PROFILE_THIS_SCOPE("jitc");
+struct IRPreloadBlock {
+	u32 address;
+	u32 mipsBytes;
+	std::vector<IRInst> instructions;
+};
 
+// Only reads memory and the frontend's own state, so separate frontends can run this in parallel.
+static void TranslateFunction(IRFrontend &frontend, u32 start_address, u32 length, std::vector<IRPreloadBlock> &blocks) {
 	// Note: we don't actually write emuhacks yet, so we can validate hashes.
 	// This way, if the game changes the code afterward, we'll catch even without icache invalidation.
 
@@ -158,13 +179,7 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 
 		std::vector<IRInst> instructions;
 		u32 mipsBytes;
-		if (!CompileBlock(em_address, instructions, mipsBytes, true)) {
-			// Ran out of block numbers - let's hope there's no more code it needs to run.
-			// Will flush when actually compiling.
-			ERROR_LOG(JIT, "Ran out of block numbers while compiling function");
-			return;
-		}
-
+		frontend.DoJit(em_address, instructions, mipsBytes, true);
 		doneAddresses.insert(em_address);
 
 		for (const IRInst &inst : instructions) {
@@ -205,6 +220,59 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 		if (em_address + mipsBytes < start_address + length) {
 			pendingAddresses.push_back(em_address + mipsBytes);
 		}
+
+		if (!instructions.empty()) {
+			blocks.push_back(IRPreloadBlock{ em_address, mipsBytes, std::move(instructions) });
+		}
+	}
+}
+
+void IRJit::CompileFunction(u32 start_address, u32 length) {
+	PROFILE_THIS_SCOPE("jitc");
+
+	std::vector<IRPreloadBlock> blocks;
+	TranslateFunction(frontend_, start_address, length, blocks);
+	for (const IRPreloadBlock &block : blocks) {
+		if (!AddBlock(block.address, block.instructions, block.mipsBytes, true)) {
+			// Ran out of block numbers - let's hope there's no more code it needs to run.
+			// Will flush when actually compiling.
+			ERROR_LOG(JIT, "Ran out of block numbers while compiling function");
+			return;
+		}
+	}
+}
+
+void IRJit::CompileFunctions(const std::vector<std::pair<u32, u32>> &funcs) {
+	PROFILE_THIS_SCOPE("jitc");
+
+	// The caller holds jitLock and waits here, so memory, blocks, and replacements stay put while
+	// each worker translates with its own frontend.
+	std::vector<std::vector<IRPreloadBlock>> translated(funcs.size());
+	std::atomic<bool> setRounding(false);
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		// Runs on a pool thread, so leave the debugger's skip state alone.
+		IRFrontend frontend(true, false);
+		frontend.CopySettingsFrom(frontend_);
+		for (int i = l; i < h; i++) {
+			TranslateFunction(frontend, funcs[i].first, funcs[i].second, translated[i]);
+		}
+		if (frontend.HasSetRounding()) {
+			setRounding = true;
+		}
+	}, 0, (int)funcs.size(), 16);
+
+	if (setRounding) {
+		frontend_.MarkSetRounding();
+	}
+
+	// Add them in order, so block numbers match compiling one by one.
+	for (const auto &blocks : translated) {
+		for (const IRPreloadBlock &block : blocks) {
+			if (!AddBlock(block.address, block.instructions, block.mipsBytes, true)) {
+				ERROR_LOG(JIT, "Ran out of block numbers while compiling functions");
+				return;
+			}
+		}
 	}
 }
 
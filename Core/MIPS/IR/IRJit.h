@@ -146,6 +146,7 @@ class IRJit : public JitInterface {
 
 	void Compile(u32 em_address) override;	// Compiles a block at current MIPS PC
 	void CompileFunction(u32 start_address, u32 length) override;
+	void CompileFunctions(const std::vector<std::pair<u32, u32>> &funcs) override;
 
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
 	// Not using a regular block cache.
@@ -172,7 +173,9 @@ class IRJit : public JitInterface {
 
 private:
 	bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	bool AddBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload);
 	bool ReplaceJalTo(u32 dest);
+	void LogPreloadStats();
 
 	JitOptions jo;
 
@@ -181,6 +184,9 @@ class IRJit : public JitInterface {
 
 	MIPSState *mips_;
 
+	// Blocks found precompiled on first execution, i.e. compiles avoided.
+	int preloadHits_ = 0;
+
 	// where to write branch-likely trampolines. not used atm
 	// u32 blTrampolines_;
 	// int blTrampolineCount_;
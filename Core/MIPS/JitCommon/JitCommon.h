@@ -19,6 +19,7 @@
 
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -135,6 +136,12 @@ namespace MIPSComp {
 		virtual void RunLoopUntil(u64 globalticks) = 0;
 		virtual void Compile(u32 em_address) = 0;
 		virtual void CompileFunction(u32 start_address, u32 length) { }
+		// Takes (start, length) pairs.  Backends may compile them in parallel, but all are done on return.
+		virtual void CompileFunctions(const std::vector<std::pair<u32, u32>> &funcs) {
+			for (const auto &func : funcs) {
+				CompileFunction(func.first, func.second);
+			}
+		}
 		virtual void ClearCache() = 0;
 		virtual void UpdateFCR31() = 0;
 		virtual MIPSOpcode GetOriginalOp(MIPSOpcode op) = 0;
@@ -28,6 +28,7 @@
 #include "Common/File/FileUtil.h"
 #include "Common/Log.h"
 #include "Common/TimeUtil.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
@@ -879,40 +880,44 @@ namespace MIPSAnalyst {
 		return DetermineRegisterUsage(reg, addr, instrs) == USAGE_CLOBBERED;
 	}
 
-	void HashFunctions() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		std::vector<u32> buffer;
+	static void HashFunction(AnalyzedFunction &f, std::vector<u32> &buffer) {
+		if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
+			return;
+		}
 
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
-			AnalyzedFunction &f = *iter;
-			if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
-				continue;
+		// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
+		buffer.resize((f.end - f.start + 4) / 4);
+		size_t pos = 0;
+		for (u32 addr = f.start; addr <= f.end; addr += 4) {
+			u32 validbits = 0xFFFFFFFF;
+			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
+			if (MIPS_IS_EMUHACK(instr)) {
+				f.hasHash = false;
+				return;
 			}
 
-			// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
-			buffer.resize((f.end - f.start + 4) / 4);
-			size_t pos = 0;
-			for (u32 addr = f.start; addr <= f.end; addr += 4) {
-				u32 validbits = 0xFFFFFFFF;
-				MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
-				if (MIPS_IS_EMUHACK(instr)) {
-					f.hasHash = false;
-					goto skip;
-				}
+			MIPSInfo flags = MIPSGetInfo(instr);
+			if (flags & IN_IMM16)
+				validbits &= ~0xFFFF;
+			if (flags & IN_IMM26)
+				validbits &= ~0x03FFFFFF;
+			buffer[pos++] = instr & validbits;
+		}
 
-				MIPSInfo flags = MIPSGetInfo(instr);
-				if (flags & IN_IMM16)
-					validbits &= ~0xFFFF;
-				if (flags & IN_IMM26)
-					validbits &= ~0x03FFFFFF;
-				buffer[pos++] = instr & validbits;
-			}
+		f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
+		f.hasHash = true;
+	}
 
-			f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
-			f.hasHash = true;
-skip:
-			;
-		}
+	void HashFunctions() {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// Functions are hashed independently, and nothing touches jit blocks or replacements while we wait.
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			std::vector<u32> buffer;
+			for (int i = l; i < h; i++) {
+				HashFunction(functions[i], buffer);
+			}
+		}, 0, (int)functions.size(), 64);
 	}
 
 	void PrecompileFunction(u32 startAddr, u32 length) {
@@ -932,10 +937,18 @@ namespace MIPSAnalyst {
 		// TODO: Load from cache file if available instead.
 
 		double st = time_now_d();
+		std::vector<std::pair<u32, u32>> ranges;
+		ranges.reserve(functions.size());
 		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
 			const AnalyzedFunction &f = *iter;
+			ranges.push_back(std::make_pair(f.start, f.end - f.start + 4));
+		}
 
-			PrecompileFunction(f.start, f.end - f.start + 4);
+		{
+			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+			if (MIPSComp::jit) {
+				MIPSComp::jit->CompileFunctions(ranges);
+			}
 		}
 		double et = time_now_d();
 
@@ -1184,7 +1197,9 @@ namespace MIPSAnalyst {
 	}
 
 	void FinalizeScan(bool insertSymbols) {
+		double st = time_now_d();
 		HashFunctions();
+		double hashedTime = time_now_d();
 
 		Path hashMapFilename = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
 		if (g_Config.bFuncHashMap || g_Config.bFuncReplacements) {
@@ -1196,9 +1211,15 @@ namespace MIPSAnalyst {
 			if (insertSymbols) {
 				ApplyHashMap();
 			}
+			double appliedTime = time_now_d();
 			if (g_Config.bFuncReplacements) {
 				ReplaceFunctions();
 			}
+			double et = time_now_d();
+
+			INFO_LOG(LOADER, "Hashed %d functions in %0.2f ms, hash map took %0.2f ms, replacements %0.2f ms", (int)functions.size(), (hashedTime - st) * 1000.0, (appliedTime - hashedTime) * 1000.0, (et - appliedTime) * 1000.0);
+		} else {
+			INFO_LOG(LOADER, "Hashed %d functions in %0.2f ms", (int)functions.size(), (hashedTime - st) * 1000.0);
 		}
 	}
 
@@ -1232,7 +1253,9 @@ namespace MIPSAnalyst {
 		fun.name[63] = 0;
 		functions.push_back(fun);
 
-		HashFunctions();
+		// Only the new one needs a hash, the rest haven't changed.
+		std::vector<u32> buffer;
+		HashFunction(functions.back(), buffer);
 	}
 
 	void ForgetFunctions(u32 startAddr, u32 endAddr) {
@@ -39,6 +39,7 @@
 #include "Common/Data/Encoding/Utf8.h"
 
 #include "Common/File/FileUtil.h"
+#include "Common/Profiler/Profiler.h"
 #include "Common/TimeUtil.h"
 #include "Common/GraphicsContext.h"
 #include "Core/MemFault.h"
@@ -235,7 +236,16 @@ bool CPU_Init(std::string *errorString) {
 	loadedFile = ResolveFileLoaderTarget(ConstructFileLoader(filename));
 #if PPSSPP_ARCH(AMD64)
 	if (g_Config.bCacheFullIsoInRam) {
-		loadedFile = new RamCachingFileLoader(loadedFile);
+#ifndef _WIN32
+		if (loadedFile->MappedData(0, (size_t)loadedFile->FileSize())) {
+			// Already mapped, so just have the OS pull it into the page cache rather than copying it.
+			loadedFile->Prefetch(0, (size_t)loadedFile->FileSize());
+		} else
+#endif
+		{
+			// Prefetch() is only a hint on Windows, so copy it as before.
+			loadedFile = new RamCachingFileLoader(loadedFile);
+		}
 	}
 #endif
 
@@ -575,6 +585,7 @@ void PSP_RunLoopUntil(u64 globalticks) {
 		return;
 	}
 
+	PROFILE_THIS_SCOPE("cpu");
 	mipsr4k.RunLoopUntil(globalticks);
 	gpu->CleanupBeforeUI();
 }
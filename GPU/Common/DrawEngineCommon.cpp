@@ -16,23 +16,48 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <cstring>
 
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/SplineCommon.h"
 #include "GPU/Common/VertexDecoderCommon.h"
 #include "GPU/ge_constants.h"
+#include "GPU/GPU.h"
 #include "GPU/GPUState.h"
 
 #define QUAD_INDICES_MAX 65536
 
+enum {
+	// Below this, waking up the workers costs more than it saves.
+	PARALLEL_DECODE_MIN_VERTS = 4096,
+	PARALLEL_DECODE_CHUNK_VERTS = 1024,
+};
+
 enum {
 	TRANSFORMED_VERTEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * sizeof(TransformedVertex)
 };
 
-DrawEngineCommon::DrawEngineCommon() : decoderMap_(16) {
+#define VERTEXCACHE_DECIMATION_INTERVAL 17
+
+enum { VAI_KILL_AGE = 120, VAI_UNRELIABLE_KILL_AGE = 240, VAI_UNRELIABLE_KILL_MAX = 4 };
+
+enum {
+	// Large arrays that have matched this many full hashes in a row only get spot checked from then on.
+	VAI_RELIABLE_FULL_HASHES = 16,
+	// ... plus a full hash every this many draws, just in case.
+	VAI_RELIABLE_FULL_HASH_INTERVAL = 240,
+};
+
+VertexArrayInfo::VertexArrayInfo() {
+	lastFrame = gpuStats.numFlips;
+}
+
+DrawEngineCommon::DrawEngineCommon() : decoderMap_(16), vai_(256) {
+	decimationCounter_ = VERTEXCACHE_DECIMATION_INTERVAL;
 	decJitCache_ = new VertexDecoderJitCache();
 	transformed = (TransformedVertex *)AllocateMemoryPages(TRANSFORMED_VERTEX_BUFFER_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
 	transformedExpanded = (TransformedVertex *)AllocateMemoryPages(3 * TRANSFORMED_VERTEX_BUFFER_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
@@ -46,6 +71,7 @@ DrawEngineCommon::~DrawEngineCommon() {
 		delete decoder;
 	});
 	ClearSplineBezierWeights();
+	ClearTrackedVertexArrays();
 }
 
 void DrawEngineCommon::Init() {
@@ -71,23 +97,10 @@ int DrawEngineCommon::ComputeNumVertsToDecode() const {
 			vertsToDecode += dc.vertexCount;
 		}
 	} else {
-		// TODO: Share this computation with DecodeVertsStep?
 		for (int i = 0; i < numDrawCalls; i++) {
-			const DeferredDrawCall &dc = drawCalls[i];
-			int lastMatch = i;
-			const int total = numDrawCalls;
-			int indexLowerBound = dc.indexLowerBound;
-			int indexUpperBound = dc.indexUpperBound;
-			for (int j = i + 1; j < total; ++j) {
-				if (drawCalls[j].verts != dc.verts)
-					break;
-
-				indexLowerBound = std::min(indexLowerBound, (int)drawCalls[j].indexLowerBound);
-				indexUpperBound = std::max(indexUpperBound, (int)drawCalls[j].indexUpperBound);
-				lastMatch = j;
-			}
+			int indexLowerBound, indexUpperBound;
+			i = FindDecodeRange(i, &indexLowerBound, &indexUpperBound);
 			vertsToDecode += indexUpperBound - indexLowerBound + 1;
-			i = lastMatch;
 		}
 	}
 	return vertsToDecode;
@@ -95,9 +108,11 @@ int DrawEngineCommon::ComputeNumVertsToDecode() const {
 
 void DrawEngineCommon::DecodeVerts(u8 *dest) {
 	const UVScale origUV = gstate_c.uv;
-	for (; decodeCounter_ < numDrawCalls; decodeCounter_++) {
-		gstate_c.uv = drawCalls[decodeCounter_].uvScale;
-		DecodeVertsStep(dest, decodeCounter_, decodedVerts_);  // NOTE! DecodeVertsStep can modify decodeCounter_!
+	if (!DecodeVertsParallel(dest)) {
+		for (; decodeCounter_ < numDrawCalls; decodeCounter_++) {
+			gstate_c.uv = drawCalls[decodeCounter_].uvScale;
+			DecodeVertsStep(dest, decodeCounter_, decodedVerts_);  // NOTE! DecodeVertsStep can modify decodeCounter_!
+		}
 	}
 	gstate_c.uv = origUV;
 
@@ -512,92 +527,155 @@ bool DrawEngineCommon::ApplyFramebufferRead(bool *fboTexNeedsBind) {
 	return true;
 }
 
+// Finds the draw calls starting at i that share vertex data, and their combined index bounds.
+// Returns the last one.
+int DrawEngineCommon::FindDecodeRange(int i, int *indexLowerBound, int *indexUpperBound) const {
+	const DeferredDrawCall &dc = drawCalls[i];
+	*indexLowerBound = dc.indexLowerBound;
+	*indexUpperBound = dc.indexUpperBound;
+	if (dc.indexType == GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT)
+		return i;
+
+	// It's fairly common that games issue long sequences of PRIM calls, with differing
+	// inds pointer but the same base vertex pointer. We'd like to reuse vertices between
+	// these as much as possible, so we make sure here to combine as many as possible
+	// into one nice big drawcall, sharing data.
+	int lastMatch = i;
+	for (int j = i + 1; j < numDrawCalls; ++j) {
+		if (drawCalls[j].verts != dc.verts)
+			break;
+
+		*indexLowerBound = std::min(*indexLowerBound, (int)drawCalls[j].indexLowerBound);
+		*indexUpperBound = std::max(*indexUpperBound, (int)drawCalls[j].indexUpperBound);
+		lastMatch = j;
+	}
+	return lastMatch;
+}
+
+// Doesn't look at the decoded vertices, so can run while they're being decoded.
+void DrawEngineCommon::GenerateIndicesStep(int first, int last, int indexLowerBound) {
+	const bool cullEnabled = gstate.isCullEnabled();
+	const int cullMode = gstate.getCullMode();
+
+	switch (drawCalls[first].indexType) {
+	case GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT:
+		for (int j = first; j <= last; j++) {
+			bool clockwise = !cullEnabled || cullMode == drawCalls[j].cullMode;
+			indexGen.AddPrim(drawCalls[j].prim, drawCalls[j].vertexCount, clockwise);
+		}
+		break;
+	case GE_VTYPE_IDX_8BIT >> GE_VTYPE_IDX_SHIFT:
+		for (int j = first; j <= last; j++) {
+			bool clockwise = !cullEnabled || cullMode == drawCalls[j].cullMode;
+			indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u8 *)drawCalls[j].inds, indexLowerBound, clockwise);
+		}
+		break;
+	case GE_VTYPE_IDX_16BIT >> GE_VTYPE_IDX_SHIFT:
+		for (int j = first; j <= last; j++) {
+			bool clockwise = !cullEnabled || cullMode == drawCalls[j].cullMode;
+			indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u16_le *)drawCalls[j].inds, indexLowerBound, clockwise);
+		}
+		break;
+	case GE_VTYPE_IDX_32BIT >> GE_VTYPE_IDX_SHIFT:
+		for (int j = first; j <= last; j++) {
+			bool clockwise = !cullEnabled || cullMode == drawCalls[j].cullMode;
+			indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u32_le *)drawCalls[j].inds, indexLowerBound, clockwise);
+		}
+		break;
+	}
+}
+
 void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts) {
 	PROFILE_THIS_SCOPE("vertdec");
 
 	const DeferredDrawCall &dc = drawCalls[i];
+	const bool indexed = dc.indexType != GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT;
 
 	indexGen.SetIndex(decodedVerts);
-	int indexLowerBound = dc.indexLowerBound;
-	int indexUpperBound = dc.indexUpperBound;
-
-	if (dc.indexType == GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT) {
-		// Decode the verts and apply morphing. Simple.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
-			dc.verts, indexLowerBound, indexUpperBound);
-		decodedVerts += indexUpperBound - indexLowerBound + 1;
-		
-		bool clockwise = true;
-		if (gstate.isCullEnabled() && gstate.getCullMode() != dc.cullMode) {
-			clockwise = false;
-		}
-		indexGen.AddPrim(dc.prim, dc.vertexCount, clockwise);
-	} else {
-		// It's fairly common that games issue long sequences of PRIM calls, with differing
-		// inds pointer but the same base vertex pointer. We'd like to reuse vertices between
-		// these as much as possible, so we make sure here to combine as many as possible
-		// into one nice big drawcall, sharing data.
-
-		// 1. Look ahead to find the max index, only looking as "matching" drawcalls.
-		//    Expand the lower and upper bounds as we go.
-		int lastMatch = i;
-		const int total = numDrawCalls;
-		for (int j = i + 1; j < total; ++j) {
-			if (drawCalls[j].verts != dc.verts)
-				break;
+	int indexLowerBound, indexUpperBound;
+	int lastMatch = FindDecodeRange(i, &indexLowerBound, &indexUpperBound);
+	GenerateIndicesStep(i, lastMatch, indexLowerBound);
 
-			indexLowerBound = std::min(indexLowerBound, (int)drawCalls[j].indexLowerBound);
-			indexUpperBound = std::max(indexUpperBound, (int)drawCalls[j].indexUpperBound);
-			lastMatch = j;
-		}
+	const int vertexCount = indexUpperBound - indexLowerBound + 1;
 
-		// 2. Loop through the drawcalls, translating indices as we go.
-		switch (dc.indexType) {
-		case GE_VTYPE_IDX_8BIT >> GE_VTYPE_IDX_SHIFT:
-			for (int j = i; j <= lastMatch; j++) {
-				bool clockwise = true;
-				if (gstate.isCullEnabled() && gstate.getCullMode() != drawCalls[j].cullMode) {
-					clockwise = false;
-				}
-				indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u8 *)drawCalls[j].inds, indexLowerBound, clockwise);
-			}
-			break;
-		case GE_VTYPE_IDX_16BIT >> GE_VTYPE_IDX_SHIFT:
-			for (int j = i; j <= lastMatch; j++) {
-				bool clockwise = true;
-				if (gstate.isCullEnabled() && gstate.getCullMode() != drawCalls[j].cullMode) {
-					clockwise = false;
-				}
-				indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u16_le *)drawCalls[j].inds, indexLowerBound, clockwise);
-			}
-			break;
-		case GE_VTYPE_IDX_32BIT >> GE_VTYPE_IDX_SHIFT:
-			for (int j = i; j <= lastMatch; j++) {
-				bool clockwise = true;
-				if (gstate.isCullEnabled() && gstate.getCullMode() != drawCalls[j].cullMode) {
-					clockwise = false;
-				}
-				indexGen.TranslatePrim(drawCalls[j].prim, drawCalls[j].vertexCount, (const u32_le *)drawCalls[j].inds, indexLowerBound, clockwise);
-			}
-			break;
-		}
+	// This check is a workaround for Pangya Fantasy Golf, which sends bogus index data when switching items in "My Room" sometimes.
+	if (indexed && decodedVerts + vertexCount > VERTEX_BUFFER_MAX) {
+		return;
+	}
 
-		const int vertexCount = indexUpperBound - indexLowerBound + 1;
+	dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
+		dc.verts, indexLowerBound, indexUpperBound);
+	decodedVerts += vertexCount;
 
-		// This check is a workaround for Pangya Fantasy Golf, which sends bogus index data when switching items in "My Room" sometimes.
-		if (decodedVerts + vertexCount > VERTEX_BUFFER_MAX) {
-			return;
-		}
+	// AddPrim already advanced the counter for non-indexed draws.
+	if (indexed)
+		indexGen.Advance(vertexCount);
+	i = lastMatch;
+}
 
-		// 3. Decode that range of vertex data.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
-			dc.verts, indexLowerBound, indexUpperBound);
-		decodedVerts += vertexCount;
+// Each vertex decodes independently, so large flushes are split across the worker threads,
+// while this thread generates indices. Returns false if the batch should be decoded serially.
+bool DrawEngineCommon::DecodeVertsParallel(u8 *dest) {
+	if (decodeCounter_ >= numDrawCalls || !dec_->IsReentrant() || g_threadManager.GetNumLooperThreads() <= 1)
+		return false;
 
-		// 4. Advance indexgen vertex counter.
-		indexGen.Advance(vertexCount);
-		i = lastMatch;
+	// The jit reads the UV scale from gstate_c, so it has to be the same for the whole batch.
+	const UVScale uv = drawCalls[decodeCounter_].uvScale;
+	for (int i = decodeCounter_ + 1; i < numDrawCalls; i++) {
+		if (memcmp(&drawCalls[i].uvScale, &uv, sizeof(uv)) != 0)
+			return false;
+	}
+
+	decodeRanges_.clear();
+	int total = 0;
+	for (int i = decodeCounter_; i < numDrawCalls; i++) {
+		DecodeRange range;
+		range.firstCall = i;
+		range.lastCall = FindDecodeRange(i, &range.indexLowerBound, &range.indexUpperBound);
+		range.firstVert = total;
+		total += range.indexUpperBound - range.indexLowerBound + 1;
+		decodeRanges_.push_back(range);
+		i = range.lastCall;
+	}
+
+	// Let the serial path deal with bogus bounds.
+	if (total < PARALLEL_DECODE_MIN_VERTS || decodedVerts_ + total > VERTEX_BUFFER_MAX)
+		return false;
+
+	gstate_c.uv = uv;
+	const VertexDecoder *dec = dec_;
+	const int stride = dec_->GetDecVtxFmt().stride;
+	u8 *base = dest + decodedVerts_ * stride;
+
+	auto decodeVerts = [&](int lower, int upper) {
+		PROFILE_THIS_SCOPE("vertdec");
+		// Ranges are sorted by firstVert, find the one containing lower.
+		auto it = std::upper_bound(decodeRanges_.begin(), decodeRanges_.end(), lower, [](int v, const DecodeRange &range) {
+			return v < range.firstVert;
+		});
+		for (--it; it != decodeRanges_.end() && it->firstVert < upper; ++it) {
+			const int count = it->indexUpperBound - it->indexLowerBound + 1;
+			const int start = std::max(lower, it->firstVert);
+			const int end = std::min(upper, it->firstVert + count);
+			const int offset = start - it->firstVert;
+			dec->DecodeVerts(base + start * stride, drawCalls[it->firstCall].verts, it->indexLowerBound + offset, it->indexLowerBound + offset + (end - start) - 1);
+		}
+	};
+	WaitableCounter *counter = ParallelRangeLoopWaitable(&g_threadManager, decodeVerts, 0, total, PARALLEL_DECODE_CHUNK_VERTS);
+
+	for (const DecodeRange &range : decodeRanges_) {
+		indexGen.SetIndex(decodedVerts_ + range.firstVert);
+		GenerateIndicesStep(range.firstCall, range.lastCall, range.indexLowerBound);
+		if (drawCalls[range.firstCall].indexType != GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT)
+			indexGen.Advance(range.indexUpperBound - range.indexLowerBound + 1);
 	}
+
+	counter->Wait();
+	delete counter;
+
+	decodedVerts_ += total;
+	decodeCounter_ = numDrawCalls;
+	return true;
 }
 
 inline u32 ComputeMiniHashRange(const void *ptr, size_t sz) {
@@ -682,6 +760,158 @@ uint64_t DrawEngineCommon::ComputeHash() {
 	return fullhash;
 }
 
+void DrawEngineCommon::ClearTrackedVertexArrays() {
+	vai_.Iterate([&](uint32_t hash, VertexArrayInfo *vai) {
+		delete vai;
+	});
+	vai_.Clear();
+	vertexCacheBytes_ = 0;
+}
+
+VertexCacheAction DrawEngineCommon::CheckVertexArray(VertexArrayInfo *vai) {
+	switch (vai->status) {
+	case VertexArrayInfo::VAI_NEW:
+		// Haven't seen this one before. We don't actually upload the vertex data yet.
+		vai->hash = ComputeHash();
+		vai->minihash = ComputeMiniHash();
+		vai->status = VertexArrayInfo::VAI_HASHING;
+		vai->drawsUntilNextFullHash = 0;
+		gpuStats.numVertexCacheMisses++;
+		return VertexCacheAction::DECODE;
+
+	// Hashing - still gaining confidence about the buffer.
+	// But if we get this far it's likely to be worth uploading the data.
+	case VertexArrayInfo::VAI_HASHING:
+	// Reliable - only the mini hash per draw, and an occasional full hash.
+	case VertexArrayInfo::VAI_RELIABLE:
+	{
+		PROFILE_THIS_SCOPE("vcachehash");
+		vai->numDraws++;
+		if (vai->lastFrame != gpuStats.numFlips) {
+			vai->numFrames++;
+		}
+
+		// The mini hash is cheap, and lets us skip a full hash when it would fail anyway.
+		bool changed = ComputeMiniHash() != vai->minihash;
+		if (!changed && vai->drawsUntilNextFullHash == 0) {
+			gpuStats.numVertexCacheRehashes++;
+			changed = ComputeHash() != vai->hash;
+			if (!changed && vai->status == VertexArrayInfo::VAI_RELIABLE) {
+				vai->drawsUntilNextFullHash = VAI_RELIABLE_FULL_HASH_INTERVAL;
+			} else if (!changed && vai->numVerts > 64) {
+				// exponential backoff up to 16 draws, then every 24
+				vai->drawsUntilNextFullHash = std::min(24, vai->numFrames);
+				if (++vai->fullHashesPassed >= VAI_RELIABLE_FULL_HASHES) {
+					vai->status = VertexArrayInfo::VAI_RELIABLE;
+					vai->drawsUntilNextFullHash = VAI_RELIABLE_FULL_HASH_INTERVAL;
+				}
+			}
+			// Otherwise, lower numbers seem much more likely to change, so keep hashing every draw.
+		} else if (!changed) {
+			vai->drawsUntilNextFullHash--;
+		}
+
+		if (changed) {
+			MarkUnreliable(vai);
+			gpuStats.numVertexCacheMisses++;
+			return VertexCacheAction::DECODE;
+		}
+
+		vai->lastFrame = gpuStats.numFlips;
+		if (vai->cachedBytes == 0) {
+			gpuStats.numVertexCacheMisses++;
+			return VertexCacheAction::UPLOAD;
+		}
+
+		gpuStats.numVertexCacheHits++;
+		gpuStats.numCachedDrawCalls++;
+		gpuStats.numCachedVertsDrawn += vai->numVerts;
+		gstate_c.vertexFullAlpha = vai->flags & VAI_FLAG_VERTEXFULLALPHA;
+		return VertexCacheAction::DRAW_CACHED;
+	}
+
+	case VertexArrayInfo::VAI_UNRELIABLE:
+	default:
+		vai->numDraws++;
+		if (vai->lastFrame != gpuStats.numFlips) {
+			vai->numFrames++;
+		}
+		gpuStats.numVertexCacheMisses++;
+		return VertexCacheAction::DECODE;
+	}
+}
+
+void DrawEngineCommon::UpdateVertexArrayInfo(VertexArrayInfo *vai) {
+	vai->numVerts = indexGen.VertexCount();
+	vai->prim = indexGen.Prim();
+	vai->maxIndex = indexGen.MaxIndex();
+	vai->flags = gstate_c.vertexFullAlpha ? VAI_FLAG_VERTEXFULLALPHA : 0;
+}
+
+void DrawEngineCommon::MarkVertexArrayCached(VertexArrayInfo *vai, u32 bytes) {
+	// Zero means nothing is cached, so never store that here.
+	vai->cachedBytes = std::max(bytes, 1U);
+	bytes = vai->cachedBytes;
+	vertexCacheBytes_ += bytes;
+	if (vertexCacheBudget_ == 0 || vertexCacheBytes_ <= vertexCacheBudget_)
+		return;
+
+	// Over budget, so release the least recently drawn buffers.  Trim a bit extra so this doesn't happen every upload.
+	std::vector<VertexArrayInfo *> cached;
+	cached.reserve(vai_.size());
+	vai_.Iterate([&](uint32_t hash, VertexArrayInfo *other) {
+		if (other != vai && other->cachedBytes != 0)
+			cached.push_back(other);
+	});
+	std::sort(cached.begin(), cached.end(), [](const VertexArrayInfo *a, const VertexArrayInfo *b) {
+		return a->lastFrame < b->lastFrame;
+	});
+
+	const size_t target = vertexCacheBudget_ - vertexCacheBudget_ / 4;
+	for (VertexArrayInfo *other : cached) {
+		if (vertexCacheBytes_ <= target)
+			break;
+		other->ReleaseBuffers();
+		vertexCacheBytes_ -= other->cachedBytes;
+		other->cachedBytes = 0;
+	}
+}
+
+void DrawEngineCommon::MarkUnreliable(VertexArrayInfo *vai) {
+	vai->status = VertexArrayInfo::VAI_UNRELIABLE;
+	vai->ReleaseBuffers();
+	vertexCacheBytes_ -= vai->cachedBytes;
+	vai->cachedBytes = 0;
+}
+
+void DrawEngineCommon::DecimateTrackedVertexArrays() {
+	if (--decimationCounter_ <= 0) {
+		decimationCounter_ = VERTEXCACHE_DECIMATION_INTERVAL;
+	} else {
+		return;
+	}
+
+	const int threshold = gpuStats.numFlips - VAI_KILL_AGE;
+	const int unreliableThreshold = gpuStats.numFlips - VAI_UNRELIABLE_KILL_AGE;
+	int unreliableLeft = VAI_UNRELIABLE_KILL_MAX;
+	vai_.Iterate([&](uint32_t hash, VertexArrayInfo *vai) {
+		bool kill;
+		if (vai->status == VertexArrayInfo::VAI_UNRELIABLE) {
+			// We limit killing unreliable so we don't rehash too often.
+			kill = vai->lastFrame < unreliableThreshold && --unreliableLeft >= 0;
+		} else {
+			kill = vai->lastFrame < threshold;
+		}
+		if (kill) {
+			// This is actually quite safe.
+			vertexCacheBytes_ -= vai->cachedBytes;
+			vai_.Remove(hash);
+			delete vai;
+		}
+	});
+	vai_.Maintain();
+}
+
 // vertTypeID is the vertex type but with the UVGen mode smashed into the top bits.
 void DrawEngineCommon::SubmitPrim(void *verts, void *inds, GEPrimitiveType prim, int vertexCount, u32 vertTypeID, int cullMode, int *bytesRead) {
 	if (!indexGen.PrimCompatible(prevPrim_, prim) || numDrawCalls >= MAX_DEFERRED_DRAW_CALLS || vertexCountInDrawCalls_ + vertexCount > VERTEX_BUFFER_MAX) {
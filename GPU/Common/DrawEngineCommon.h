@@ -33,6 +33,8 @@ enum {
 	VERTEX_BUFFER_MAX = 65536,
 	DECODED_VERTEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * 64,
 	DECODED_INDEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * 16,
+	// For backends that can free cached vertex arrays individually.
+	VERTEX_CACHE_BUDGET = 64 * 1024 * 1024,
 };
 
 inline uint32_t GetVertTypeID(uint32_t vertType, int uvGenMode) {
@@ -51,6 +53,60 @@ class TessellationDataTransfer {
 	virtual void SendDataToShader(const SimpleVertex *const *points, int size_u, int size_v, u32 vertType, const Spline::Weight2D &weights) = 0;
 };
 
+enum {
+	VAI_FLAG_VERTEXFULLALPHA = 1,
+};
+
+// Vertex caching (bVertexCache) state for one repeated draw, keyed by the draw call ID.  The states
+// and hashing are shared by all backends; they subclass this to hold their own buffers.
+//
+// VAI_NEW -> VAI_HASHING -> VAI_RELIABLE
+//                 \              /
+//                 VAI_UNRELIABLE  (data changed, just decode it every time until forgotten)
+class VertexArrayInfo {
+public:
+	VertexArrayInfo();
+	virtual ~VertexArrayInfo() {}
+
+	// Frees the backend's buffers for this entry, if any.  The entry itself stays tracked.
+	virtual void ReleaseBuffers() {}
+
+	enum Status : uint8_t {
+		VAI_NEW,
+		VAI_HASHING,
+		VAI_RELIABLE,  // cache, only spot check the data
+		VAI_UNRELIABLE,  // never cache
+	};
+
+	uint64_t hash = 0;
+	u32 minihash = 0;
+	// Bytes of buffers held for this entry, counted against the cache budget.
+	u32 cachedBytes = 0;
+
+	// Precalculated draw parameters.
+	u16 numVerts = 0;
+	u16 maxIndex = 0;
+	s8 prim = GE_PRIM_INVALID;
+	Status status = VAI_NEW;
+
+	// ID information
+	int numDraws = 0;
+	int numFrames = 0;
+	int lastFrame;  // So that we can forget.
+	u16 drawsUntilNextFullHash = 0;
+	u16 fullHashesPassed = 0;
+	u8 flags = 0;
+};
+
+enum class VertexCacheAction {
+	// Not (or no longer) worth caching - decode as usual.
+	DECODE,
+	// The data looks stable, decode it and keep it in the entry's buffers.
+	UPLOAD,
+	// Draw using the entry's buffers.
+	DRAW_CACHED,
+};
+
 class DrawEngineCommon {
 public:
 	DrawEngineCommon();
@@ -102,9 +158,10 @@ class DrawEngineCommon {
 
 	VertexDecoder *GetVertexDecoder(u32 vtype);
 
+	virtual void ClearTrackedVertexArrays();
+
 protected:
 	virtual bool UpdateUseHWTessellation(bool enabled) { return enabled; }
-	virtual void ClearTrackedVertexArrays() {}
 
 	int ComputeNumVertsToDecode() const;
 	void DecodeVerts(u8 *dest);
@@ -116,8 +173,29 @@ class DrawEngineCommon {
 	u32 ComputeMiniHash();
 	uint64_t ComputeHash();
 
+	// Vertex caching.  Backends look up the entry for the current draw, then do what CheckVertexArray() says.
+	template <typename T>
+	T *GetVertexArrayInfo(u32 id) {
+		VertexArrayInfo *vai = vai_.Get(id);
+		if (!vai) {
+			vai = new T();
+			vai_.Insert(id, vai);
+		}
+		return static_cast<T *>(vai);
+	}
+	VertexCacheAction CheckVertexArray(VertexArrayInfo *vai);
+	// Records the draw parameters from the last decode.
+	void UpdateVertexArrayInfo(VertexArrayInfo *vai);
+	// Call after filling the entry's buffers for VertexCacheAction::UPLOAD.
+	void MarkVertexArrayCached(VertexArrayInfo *vai, u32 bytes);
+	void MarkUnreliable(VertexArrayInfo *vai);
+	void DecimateTrackedVertexArrays();
+
 	// Vertex decoding
 	void DecodeVertsStep(u8 *dest, int &i, int &decodedVerts);
+	int FindDecodeRange(int i, int *indexLowerBound, int *indexUpperBound) const;
+	void GenerateIndicesStep(int first, int last, int indexLowerBound);
+	bool DecodeVertsParallel(u8 *dest);
 
 	bool ApplyFramebufferRead(bool *fboTexNeedsBind);
 
@@ -166,10 +244,26 @@ class DrawEngineCommon {
 	int numDrawCalls = 0;
 	int vertexCountInDrawCalls_ = 0;
 
+	// Used by DecodeVertsParallel, vertices are relative to the start of the batch.
+	struct DecodeRange {
+		int firstCall;
+		int lastCall;
+		int indexLowerBound;
+		int indexUpperBound;
+		int firstVert;
+	};
+	std::vector<DecodeRange> decodeRanges_;
+
 	int decimationCounter_ = 0;
 	int decodeCounter_ = 0;
 	u32 dcid_ = 0;
 
+	PrehashMap<VertexArrayInfo *, nullptr> vai_;
+	size_t vertexCacheBytes_ = 0;
+	// When set, the least recently used entries are released to stay within this.
+	// Backends that can't free individual entries leave it at 0.
+	size_t vertexCacheBudget_ = 0;
+
 	// Vertex collector state
 	IndexGenerator indexGen;
 	int decodedVerts_ = 0;
@@ -168,6 +168,41 @@ void SoftwareTransform::SetProjMatrix(float mtx[14], bool invertedX, bool invert
 	projMatrix_.translateAndScale(trans, scale);
 }
 
+// Takes world space positions in pos, applies the view and projection matrices, and computes fog.
+// This is done four vertices at a time, with the same rounding as doing them one by one.
+static void TransformViewProjFog(TransformedVertex *transformed, int count, const float projMatrix[16], float fogEnd, float fogSlope) {
+	int index = 0;
+#ifdef MATH3D_HAS_X4
+	for (; index + 4 <= count; index += 4) {
+		TransformedVertex *vert = transformed + index;
+		Vec4Lanes world[4];
+		Load4x4Transposed(world, vert[0].pos, vert[1].pos, vert[2].pos, vert[3].pos);
+
+		Vec4Lanes view[3];
+		Vec3ByMatrix43x4(view, world[0], world[1], world[2], gstate.viewMatrix);
+		alignas(16) float fogCoef[4];
+#if defined(_M_SSE)
+		_mm_store_ps(fogCoef, _mm_mul_ps(_mm_add_ps(view[2], _mm_set1_ps(fogEnd)), _mm_set1_ps(fogSlope)));
+#else
+		vst1q_f32(fogCoef, vmulq_f32(vaddq_f32(view[2], vdupq_n_f32(fogEnd)), vdupq_n_f32(fogSlope)));
+#endif
+
+		Vec4Lanes clip[4];
+		Vec3ByMatrix44x4(clip, view[0], view[1], view[2], projMatrix);
+		Store4x4Transposed(vert[0].pos, vert[1].pos, vert[2].pos, vert[3].pos, clip);
+		for (int i = 0; i < 4; ++i)
+			vert[i].fog = fogCoef[i];
+	}
+#endif
+
+	for (; index < count; ++index) {
+		float v[3];
+		Vec3ByMatrix43(v, transformed[index].pos, gstate.viewMatrix);
+		transformed[index].fog = (v[2] + fogEnd) * fogSlope;
+		Vec3ByMatrix44(transformed[index].pos, v, projMatrix);
+	}
+}
+
 void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVtxFormat, int maxIndex, SoftwareTransformResult *result) {
 	u8 *decoded = params_.decoded;
 	TransformedVertex *transformed = params_.transformed;
@@ -246,11 +281,9 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 		for (int index = 0; index < maxIndex; index++) {
 			reader.Goto(index);
 
-			float v[3] = {0, 0, 0};
 			Vec4f c0 = Vec4f(1, 1, 1, 1);
 			Vec4f c1 = Vec4f(0, 0, 0, 0);
 			float uv[3] = {0, 0, 1};
-			float fogCoef = 1.0f;
 
 			float out[3];
 			float pos[3];
@@ -426,19 +459,17 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 			uv[0] = uv[0] * widthFactor;
 			uv[1] = uv[1] * heightFactor;
 
-			// Transform the coord by the view matrix.
-			Vec3ByMatrix43(v, out, gstate.viewMatrix);
-			fogCoef = (v[2] + fog_end) * fog_slope;
-
+			// The view and projection transforms are done below, in batches.
 			// TODO: Write to a flexible buffer, we don't always need all four components.
-			Vec3ByMatrix44(transformed[index].pos, v, projMatrix_.m);
-			transformed[index].fog = fogCoef;
+			memcpy(transformed[index].pos, out, 3 * sizeof(float));
 			memcpy(&transformed[index].uv, uv, 3 * sizeof(float));
 			transformed[index].color0_32 = c0.ToRGBA();
 			transformed[index].color1_32 = c1.ToRGBA();
 
 			// Vertex depth rounding is done in the shader, to simulate the 16-bit depth buffer.
 		}
+
+		TransformViewProjFog(transformed, maxIndex, projMatrix_.m, fog_end, fog_slope);
 	}
 
 	// Here's the best opportunity to try to detect rectangles used to clear the screen, and
@@ -17,10 +17,13 @@
 
 #include <string.h>
 #include <algorithm>
+#include <type_traits>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "GPU/Common/GPUStateUtils.h"
 #include "GPU/Common/SplineCommon.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -277,6 +280,38 @@ class Spline3DWeight {
 WeightCache<Bezier3DWeight> Bezier3DWeight::weightsCache;
 WeightCache<Spline3DWeight> Spline3DWeight::weightsCache;
 
+// Indices only depend on the layout of the surface, not the control points, so they're cached too.
+static std::unordered_map<u64, std::vector<u16>> indexCache;
+enum {
+	MAX_CACHED_INDEX_BUFFERS = 256,
+	// Below this many output vertices, it's not worth waking up other threads.
+	PARALLEL_TESS_MIN_VERTS = 4096,
+};
+
+template<class Surface>
+static void BuildIndexCached(OutputBuffers &output, const Surface &surface) {
+	// Tessellation factors and patch counts all fit easily in 14 bits.
+	u64 key = (u64)std::is_same<Surface, BezierSurface>::value << 58;
+	key |= (u64)(surface.primType & 3) << 56;
+	key |= (u64)(surface.tess_u & 0x3FFF) << 42;
+	key |= (u64)(surface.tess_v & 0x3FFF) << 28;
+	key |= (u64)(surface.num_patches_u & 0x3FFF) << 14;
+	key |= (u64)(surface.num_patches_v & 0x3FFF);
+
+	auto it = indexCache.find(key);
+	if (it != indexCache.end()) {
+		memcpy(output.indices, it->second.data(), it->second.size() * sizeof(u16));
+		output.count = (int)it->second.size();
+		return;
+	}
+
+	output.count = 0;
+	surface.BuildIndex(output.indices, output.count);
+	if (indexCache.size() >= MAX_CACHED_INDEX_BUFFERS)
+		indexCache.clear();
+	indexCache[key].assign(output.indices, output.indices + output.count);
+}
+
 // Tessellate single patch (4x4 control points)
 template<typename T>
 class Tessellator {
@@ -337,73 +372,89 @@ template<class Surface>
 class SubdivisionSurface {
 public:
 	template <bool sampleNrm, bool sampleCol, bool sampleTex, bool useSSE4, bool patchFacing>
-	static void Tessellate(OutputBuffers &output, const Surface &surface, const ControlPoints &points, const Weight2D &weights) {
+	static void TessellatePatch(OutputBuffers &output, const Surface &surface, const ControlPoints &points, const Weight2D &weights, int patch_u, int patch_v) {
 		const float inv_u = 1.0f / (float)surface.tess_u;
 		const float inv_v = 1.0f / (float)surface.tess_v;
-
-		for (int patch_u = 0; patch_u < surface.num_patches_u; ++patch_u) {
-			const int start_u = surface.GetTessStart(patch_u);
-			for (int patch_v = 0; patch_v < surface.num_patches_v; ++patch_v) {
-				const int start_v = surface.GetTessStart(patch_v);
-
-				// Prepare 4x4 control points to tessellate
-				const int idx = surface.GetPointIndex(patch_u, patch_v);
-				const int idx_v[4] = { idx, idx + surface.num_points_u, idx + surface.num_points_u * 2, idx + surface.num_points_u * 3 };
-				Tessellator<Vec3f> tess_pos(points.pos, idx_v);
-				Tessellator<Vec4f> tess_col(points.col, idx_v);
-				Tessellator<Vec2f> tess_tex(points.tex, idx_v);
-				Tessellator<Vec3f> tess_nrm(points.pos, idx_v);
-
-				for (int tile_u = start_u; tile_u <= surface.tess_u; ++tile_u) {
-					const int index_u = surface.GetIndexU(patch_u, tile_u);
-					const Weight &wu = weights.u[index_u];
-
-					// Pre-tessellate U lines
-					tess_pos.SampleU(wu.basis);
-					if (sampleCol)
-						tess_col.SampleU(wu.basis);
-					if (sampleTex)
-						tess_tex.SampleU(wu.basis);
-					if (sampleNrm)
-						tess_nrm.SampleU(wu.deriv);
-
-					for (int tile_v = start_v; tile_v <= surface.tess_v; ++tile_v) {
-						const int index_v = surface.GetIndexV(patch_v, tile_v);
-						const Weight &wv = weights.v[index_v];
-
-						SimpleVertex &vert = output.vertices[surface.GetIndex(index_u, index_v, patch_u, patch_v)];
-
-						// Tessellate
-						vert.pos = tess_pos.SampleV(wv.basis);
-						if (sampleCol) {
-							vert.color_32 = tess_col.SampleV(wv.basis).ToRGBA();
-						} else {
-							vert.color_32 = points.defcolor;
-						}
-						if (sampleTex) {
-							tess_tex.SampleV(wv.basis).Write(vert.uv);
-						} else {
-							// Generate texcoord
-							vert.uv[0] = patch_u + tile_u * inv_u;
-							vert.uv[1] = patch_v + tile_v * inv_v;
-						}
-						if (sampleNrm) {
-							const Vec3f derivU = tess_nrm.SampleV(wv.basis);
-							const Vec3f derivV = tess_pos.SampleV(wv.deriv);
-
-							vert.nrm = Cross(derivU, derivV).Normalized(useSSE4);
-							if (patchFacing)
-								vert.nrm *= -1.0f;
-						} else {
-							vert.nrm.SetZero();
-							vert.nrm.z = 1.0f;
-						}
-					}
+		const int start_u = surface.GetTessStart(patch_u);
+		const int start_v = surface.GetTessStart(patch_v);
+
+		// Prepare 4x4 control points to tessellate
+		const int idx = surface.GetPointIndex(patch_u, patch_v);
+		const int idx_v[4] = { idx, idx + surface.num_points_u, idx + surface.num_points_u * 2, idx + surface.num_points_u * 3 };
+		Tessellator<Vec3f> tess_pos(points.pos, idx_v);
+		Tessellator<Vec4f> tess_col(points.col, idx_v);
+		Tessellator<Vec2f> tess_tex(points.tex, idx_v);
+		Tessellator<Vec3f> tess_nrm(points.pos, idx_v);
+
+		for (int tile_u = start_u; tile_u <= surface.tess_u; ++tile_u) {
+			const int index_u = surface.GetIndexU(patch_u, tile_u);
+			const Weight &wu = weights.u[index_u];
+
+			// Pre-tessellate U lines
+			tess_pos.SampleU(wu.basis);
+			if (sampleCol)
+				tess_col.SampleU(wu.basis);
+			if (sampleTex)
+				tess_tex.SampleU(wu.basis);
+			if (sampleNrm)
+				tess_nrm.SampleU(wu.deriv);
+
+			for (int tile_v = start_v; tile_v <= surface.tess_v; ++tile_v) {
+				const int index_v = surface.GetIndexV(patch_v, tile_v);
+				const Weight &wv = weights.v[index_v];
+
+				SimpleVertex &vert = output.vertices[surface.GetIndex(index_u, index_v, patch_u, patch_v)];
+
+				// Tessellate
+				vert.pos = tess_pos.SampleV(wv.basis);
+				if (sampleCol) {
+					vert.color_32 = tess_col.SampleV(wv.basis).ToRGBA();
+				} else {
+					vert.color_32 = points.defcolor;
+				}
+				if (sampleTex) {
+					tess_tex.SampleV(wv.basis).Write(vert.uv);
+				} else {
+					// Generate texcoord
+					vert.uv[0] = patch_u + tile_u * inv_u;
+					vert.uv[1] = patch_v + tile_v * inv_v;
+				}
+				if (sampleNrm) {
+					const Vec3f derivU = tess_nrm.SampleV(wv.basis);
+					const Vec3f derivV = tess_pos.SampleV(wv.deriv);
+
+					vert.nrm = Cross(derivU, derivV).Normalized(useSSE4);
+					if (patchFacing)
+						vert.nrm *= -1.0f;
+				} else {
+					vert.nrm.SetZero();
+					vert.nrm.z = 1.0f;
 				}
 			}
 		}
+	}
 
-		surface.BuildIndex(output.indices, output.count);
+	template <bool sampleNrm, bool sampleCol, bool sampleTex, bool useSSE4, bool patchFacing>
+	static void Tessellate(OutputBuffers &output, const Surface &surface, const ControlPoints &points, const Weight2D &weights) {
+		// Patches never write the same vertices (shared spline edges are only output by the first), so they can run in parallel.
+		const int num_patches = surface.num_patches_u * surface.num_patches_v;
+		auto tessellatePatches = [&](int lower, int upper) {
+			for (int patch = lower; patch < upper; ++patch) {
+				TessellatePatch<sampleNrm, sampleCol, sampleTex, useSSE4, patchFacing>(output, surface, points, weights, patch % surface.num_patches_u, patch / surface.num_patches_u);
+			}
+		};
+
+		const int num_verts = (surface.num_patches_u * surface.tess_u + 1) * (surface.num_patches_v * surface.tess_v + 1);
+		if (num_patches > 1 && num_verts >= PARALLEL_TESS_MIN_VERTS && g_threadManager.GetNumLooperThreads() > 1) {
+			WaitableCounter *counter = ParallelRangeLoopWaitable(&g_threadManager, tessellatePatches, 0, num_patches, 1);
+			// Meanwhile, indices don't depend on the vertices.
+			BuildIndexCached(output, surface);
+			counter->Wait();
+			delete counter;
+		} else {
+			tessellatePatches(0, num_patches);
+			BuildIndexCached(output, surface);
+		}
 	}
 
 	using TessFunc = void(*)(OutputBuffers &, const Surface &, const ControlPoints &, const Weight2D &);
@@ -473,7 +524,7 @@ static void HardwareTessellation(OutputBuffers &output, const Surface &surface,
 			}
 		}
 	}
-	surface.BuildIndex(output.indices, output.count);
+	BuildIndexCached(output, surface);
 }
 
 } // namespace Spline
@@ -483,6 +534,7 @@ using namespace Spline;
 void DrawEngineCommon::ClearSplineBezierWeights() {
 	Bezier3DWeight::weightsCache.Clear();
 	Spline3DWeight::weightsCache.Clear();
+	indexCache.clear();
 }
 
 // Specialize to make instance (to avoid link error).
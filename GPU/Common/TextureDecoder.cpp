@@ -30,7 +30,9 @@
 
 #ifdef _M_SSE
 #include <emmintrin.h>
+#include <tmmintrin.h>
 #include <smmintrin.h>
+#include <immintrin.h>
 
 u32 QuickTexHashSSE2(const void *checkp, u32 size) {
 	u32 check = 0;
@@ -306,37 +308,7 @@ void DoUnswizzleTex16Basic(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32
 	}
 }
 
-#if !PPSSPP_ARCH(ARM64) && !defined(_M_SSE)
-QuickTexHashFunc DoQuickTexHash = &QuickTexHashBasic;
-QuickTexHashFunc StableQuickTexHash = &QuickTexHashNonSSE;
-UnswizzleTex16Func DoUnswizzleTex16 = &DoUnswizzleTex16Basic;
-#endif
-
-// This has to be done after CPUDetect has done its magic.
-void SetupTextureDecoder() {
-#if PPSSPP_ARCH(ARM_NEON) && !PPSSPP_ARCH(ARM64)
-	if (cpu_info.bNEON) {
-		DoQuickTexHash = &QuickTexHashNEON;
-		StableQuickTexHash = &QuickTexHashNEON;
-		DoUnswizzleTex16 = &DoUnswizzleTex16NEON;
-	}
-#endif
-}
-
 // S3TC / DXT Decoder
-class DXTDecoder {
-public:
-	inline void DecodeColors(const DXT1Block *src, bool ignore1bitAlpha);
-	inline void DecodeAlphaDXT5(const DXT5Block *src);
-	inline void WriteColorsDXT1(u32 *dst, const DXT1Block *src, int pitch, int height);
-	inline void WriteColorsDXT3(u32 *dst, const DXT3Block *src, int pitch, int height);
-	inline void WriteColorsDXT5(u32 *dst, const DXT5Block *src, int pitch, int height);
-
-protected:
-	u32 colors_[4];
-	u8 alpha_[8];
-};
-
 static inline u32 makecol(int r, int g, int b, int a) {
 	return (a << 24) | (b << 16) | (g << 8) | r;
 }
@@ -345,8 +317,7 @@ static inline int mix_2_3(int c1, int c2) {
 	return (c1 + c1 + c2) / 3;
 }
 
-// This could probably be done faster by decoding two or four blocks at a time with SSE/NEON.
-void DXTDecoder::DecodeColors(const DXT1Block *src, bool ignore1bitAlpha) {
+void DecodeDXTColors(u32 colors[4], const DXT1Block *src, bool ignore1bitAlpha) {
 	u16 c1 = src->color1;
 	u16 c2 = src->color2;
 	int blue1 = (c1 << 3) & 0xF8;
@@ -359,18 +330,18 @@ void DXTDecoder::DecodeColors(const DXT1Block *src, bool ignore1bitAlpha) {
 	// Keep alpha zero for non-DXT1 to skip masking the colors.
 	int alpha = ignore1bitAlpha ? 0 : 255;
 
-	colors_[0] = makecol(red1, green1, blue1, alpha);
-	colors_[1] = makecol(red2, green2, blue2, alpha);
+	colors[0] = makecol(red1, green1, blue1, alpha);
+	colors[1] = makecol(red2, green2, blue2, alpha);
 	if (c1 > c2) {
-		colors_[2] = makecol(mix_2_3(red1, red2), mix_2_3(green1, green2), mix_2_3(blue1, blue2), alpha);
-		colors_[3] = makecol(mix_2_3(red2, red1), mix_2_3(green2, green1), mix_2_3(blue2, blue1), alpha);
+		colors[2] = makecol(mix_2_3(red1, red2), mix_2_3(green1, green2), mix_2_3(blue1, blue2), alpha);
+		colors[3] = makecol(mix_2_3(red2, red1), mix_2_3(green2, green1), mix_2_3(blue2, blue1), alpha);
 	} else {
 		// Average - these are always left shifted, so no need to worry about ties.
 		int red3 = (red1 + red2) / 2;
 		int green3 = (green1 + green2) / 2;
 		int blue3 = (blue1 + blue2) / 2;
-		colors_[2] = makecol(red3, green3, blue3, alpha);
-		colors_[3] = makecol(0, 0, 0, 0);
+		colors[2] = makecol(red3, green3, blue3, alpha);
+		colors[3] = makecol(0, 0, 0, 0);
 	}
 }
 
@@ -387,62 +358,23 @@ static inline u8 lerp6(const DXT5Block *src, int n) {
 	return (u8)((alpha1 + alpha2 + 31) >> 8);
 }
 
-void DXTDecoder::DecodeAlphaDXT5(const DXT5Block *src) {
-	alpha_[0] = src->alpha1;
-	alpha_[1] = src->alpha2;
-	if (alpha_[0] > alpha_[1]) {
-		alpha_[2] = lerp8(src, 1);
-		alpha_[3] = lerp8(src, 2);
-		alpha_[4] = lerp8(src, 3);
-		alpha_[5] = lerp8(src, 4);
-		alpha_[6] = lerp8(src, 5);
-		alpha_[7] = lerp8(src, 6);
+void DecodeDXT5Alpha(u8 alpha[8], const DXT5Block *src) {
+	alpha[0] = src->alpha1;
+	alpha[1] = src->alpha2;
+	if (alpha[0] > alpha[1]) {
+		alpha[2] = lerp8(src, 1);
+		alpha[3] = lerp8(src, 2);
+		alpha[4] = lerp8(src, 3);
+		alpha[5] = lerp8(src, 4);
+		alpha[6] = lerp8(src, 5);
+		alpha[7] = lerp8(src, 6);
 	} else {
-		alpha_[2] = lerp6(src, 1);
-		alpha_[3] = lerp6(src, 2);
-		alpha_[4] = lerp6(src, 3);
-		alpha_[5] = lerp6(src, 4);
-		alpha_[6] = 0;
-		alpha_[7] = 255;
-	}
-}
-
-void DXTDecoder::WriteColorsDXT1(u32 *dst, const DXT1Block *src, int pitch, int height) {
-	for (int y = 0; y < height; y++) {
-		int colordata = src->lines[y];
-		for (int x = 0; x < 4; x++) {
-			dst[x] = colors_[colordata & 3];
-			colordata >>= 2;
-		}
-		dst += pitch;
-	}
-}
-
-void DXTDecoder::WriteColorsDXT3(u32 *dst, const DXT3Block *src, int pitch, int height) {
-	for (int y = 0; y < height; y++) {
-		int colordata = src->color.lines[y];
-		u32 alphadata = src->alphaLines[y];
-		for (int x = 0; x < 4; x++) {
-			dst[x] = colors_[colordata & 3] | (alphadata << 28);
-			colordata >>= 2;
-			alphadata >>= 4;
-		}
-		dst += pitch;
-	}
-}
-
-void DXTDecoder::WriteColorsDXT5(u32 *dst, const DXT5Block *src, int pitch, int height) {
-	// 48 bits, 3 bit index per pixel, 12 bits per line.
-	u64 alphadata = ((u64)(u16)src->alphadata1 << 32) | (u32)src->alphadata2;
-
-	for (int y = 0; y < height; y++) {
-		int colordata = src->color.lines[y];
-		for (int x = 0; x < 4; x++) {
-			dst[x] = colors_[colordata & 3] | (alpha_[alphadata & 7] << 24);
-			colordata >>= 2;
-			alphadata >>= 3;
-		}
-		dst += pitch;
+		alpha[2] = lerp6(src, 1);
+		alpha[3] = lerp6(src, 2);
+		alpha[4] = lerp6(src, 3);
+		alpha[5] = lerp6(src, 4);
+		alpha[6] = 0;
+		alpha[7] = 255;
 	}
 }
 
@@ -509,24 +441,277 @@ uint32_t GetDXT5Texel(const DXT5Block *src, int x, int y) {
 	return color | (lerp6(src, alphaIndex - 1) << 24);
 }
 
-// This could probably be done faster by decoding two or four blocks at a time with SSE/NEON.
-void DecodeDXT1Block(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha) {
-	DXTDecoder dxt;
-	dxt.DecodeColors(src, ignore1bitAlpha);
-	dxt.WriteColorsDXT1(dst, src, pitch, height);
+void DecodeDXT1BlockBasic(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha) {
+	u32 colors[4];
+	DecodeDXTColors(colors, src, ignore1bitAlpha);
+	for (int y = 0; y < height; y++) {
+		int colordata = src->lines[y];
+		for (int x = 0; x < 4; x++) {
+			dst[x] = colors[colordata & 3];
+			colordata >>= 2;
+		}
+		dst += pitch;
+	}
+}
+
+void DecodeDXT3BlockBasic(u32 *dst, const DXT3Block *src, int pitch, int height) {
+	u32 colors[4];
+	DecodeDXTColors(colors, &src->color, true);
+	for (int y = 0; y < height; y++) {
+		int colordata = src->color.lines[y];
+		u32 alphadata = src->alphaLines[y];
+		for (int x = 0; x < 4; x++) {
+			dst[x] = colors[colordata & 3] | (alphadata << 28);
+			colordata >>= 2;
+			alphadata >>= 4;
+		}
+		dst += pitch;
+	}
+}
+
+void DecodeDXT5BlockBasic(u32 *dst, const DXT5Block *src, int pitch, int height) {
+	u32 colors[4];
+	u8 alpha[8];
+	DecodeDXTColors(colors, &src->color, true);
+	DecodeDXT5Alpha(alpha, src);
+
+	// 48 bits, 3 bit index per pixel, 12 bits per line.
+	u64 alphadata = ((u64)(u16)src->alphadata1 << 32) | (u32)src->alphadata2;
+	for (int y = 0; y < height; y++) {
+		int colordata = src->color.lines[y];
+		for (int x = 0; x < 4; x++) {
+			dst[x] = colors[colordata & 3] | (alpha[alphadata & 7] << 24);
+			colordata >>= 2;
+			alphadata >>= 3;
+		}
+		dst += pitch;
+	}
+}
+
+void DeIndexTexture4Simple16Basic(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	for (int i = 0; i < length; i += 2) {
+		u8 index = *indexed++;
+		dest[i + 0] = clut[(index >> 0) & 0xf];
+		dest[i + 1] = clut[(index >> 4) & 0xf];
+	}
+}
+
+void DeIndexTexture4Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	for (int i = 0; i < length; i += 2) {
+		u8 index = *indexed++;
+		dest[i + 0] = clut[(index >> 0) & 0xf];
+		dest[i + 1] = clut[(index >> 4) & 0xf];
+	}
+}
+
+void DeIndexTexture8Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	for (int i = 0; i < length; ++i) {
+		dest[i] = clut[indexed[i]];
+	}
 }
 
-void DecodeDXT3Block(u32 *dst, const DXT3Block *src, int pitch, int height) {
-	DXTDecoder dxt;
-	dxt.DecodeColors(&src->color, true);
-	dxt.WriteColorsDXT3(dst, src, pitch, height);
+#ifdef _M_SSE
+// For each possible DXT line byte, a pshufb mask picking the four 32-bit colors it indexes.
+alignas(16) static u8 dxtLineShuffle[256][16];
+
+static void InitDXTLineShuffle() {
+	for (int line = 0; line < 256; ++line) {
+		for (int x = 0; x < 4; ++x) {
+			int index = (line >> (x * 2)) & 3;
+			for (int b = 0; b < 4; ++b)
+				dxtLineShuffle[line][x * 4 + b] = (u8)(index * 4 + b);
+		}
+	}
 }
 
-void DecodeDXT5Block(u32 *dst, const DXT5Block *src, int pitch, int height) {
-	DXTDecoder dxt;
-	dxt.DecodeColors(&src->color, true);
-	dxt.DecodeAlphaDXT5(src);
-	dxt.WriteColorsDXT5(dst, src, pitch, height);
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static void DecodeDXT1BlockSSSE3(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha) {
+	alignas(16) u32 colors[4];
+	DecodeDXTColors(colors, src, ignore1bitAlpha);
+	const __m128i palette = _mm_load_si128((const __m128i *)colors);
+	for (int y = 0; y < height; y++) {
+		const __m128i mask = _mm_load_si128((const __m128i *)dxtLineShuffle[src->lines[y]]);
+		_mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(palette, mask));
+		dst += pitch;
+	}
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static void DecodeDXT3BlockSSSE3(u32 *dst, const DXT3Block *src, int pitch, int height) {
+	alignas(16) u32 colors[4];
+	DecodeDXTColors(colors, &src->color, true);
+	const __m128i palette = _mm_load_si128((const __m128i *)colors);
+	const __m128i alphaMask = _mm_set1_epi32(0xF0000000);
+	for (int y = 0; y < height; y++) {
+		const __m128i mask = _mm_load_si128((const __m128i *)dxtLineShuffle[src->color.lines[y]]);
+		u32 alphadata = src->alphaLines[y];
+		__m128i alpha = _mm_setr_epi32(alphadata << 28, alphadata << 24, alphadata << 20, alphadata << 16);
+		alpha = _mm_and_si128(alpha, alphaMask);
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_shuffle_epi8(palette, mask), alpha));
+		dst += pitch;
+	}
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static void DecodeDXT5BlockSSSE3(u32 *dst, const DXT5Block *src, int pitch, int height) {
+	alignas(16) u32 colors[4];
+	alignas(16) u8 alpha[16]{};
+	DecodeDXTColors(colors, &src->color, true);
+	DecodeDXT5Alpha(alpha, src);
+	const __m128i palette = _mm_load_si128((const __m128i *)colors);
+	const __m128i alphaTable = _mm_load_si128((const __m128i *)alpha);
+
+	u64 alphadata = ((u64)(u16)src->alphadata1 << 32) | (u32)src->alphadata2;
+	for (int y = 0; y < height; y++) {
+		const __m128i mask = _mm_load_si128((const __m128i *)dxtLineShuffle[src->color.lines[y]]);
+		// Place each alpha index in the top byte of its lane, with 0x80 (zero) below it.
+		u32 a = (u32)alphadata;
+		__m128i alphaShuffle = _mm_setr_epi32(((a & 7) << 24) | 0x808080, (((a >> 3) & 7) << 24) | 0x808080, (((a >> 6) & 7) << 24) | 0x808080, (((a >> 9) & 7) << 24) | 0x808080);
+		__m128i color = _mm_shuffle_epi8(palette, mask);
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(color, _mm_shuffle_epi8(alphaTable, alphaShuffle)));
+		alphadata >>= 12;
+		dst += pitch;
+	}
+}
+
+// Splits 16 nibble indices (8 bytes) into one byte each, in pixel order.
+static inline __m128i ExpandNibbles(const u8 *indexed) {
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	__m128i in = _mm_loadl_epi64((const __m128i *)indexed);
+	__m128i lo = _mm_and_si128(in, mask);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+	return _mm_unpacklo_epi8(lo, hi);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static void DeIndexTexture4Simple16SSSE3(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	// Split the 16 entry clut into planes of low and high bytes, so pshufb can look up each.
+	const __m128i deinterleave = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+	__m128i c0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)clut), deinterleave);
+	__m128i c1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + 8)), deinterleave);
+	const __m128i plane0 = _mm_unpacklo_epi64(c0, c1);
+	const __m128i plane1 = _mm_unpackhi_epi64(c0, c1);
+
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m128i index = ExpandNibbles(indexed);
+		__m128i lo = _mm_shuffle_epi8(plane0, index);
+		__m128i hi = _mm_shuffle_epi8(plane1, index);
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_unpacklo_epi8(lo, hi));
+		_mm_storeu_si128((__m128i *)(dest + i + 8), _mm_unpackhi_epi8(lo, hi));
+		indexed += 8;
+	}
+	if (i < length)
+		DeIndexTexture4Simple16Basic(dest + i, indexed, length - i, clut);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static void DeIndexTexture4Simple32SSSE3(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	// Transpose the 16 entry clut into four byte planes.
+	const __m128i deinterleave = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+	__m128i c0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)clut), deinterleave);
+	__m128i c1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + 4)), deinterleave);
+	__m128i c2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + 8)), deinterleave);
+	__m128i c3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + 12)), deinterleave);
+	__m128i c01lo = _mm_unpacklo_epi32(c0, c1);
+	__m128i c23lo = _mm_unpacklo_epi32(c2, c3);
+	__m128i c01hi = _mm_unpackhi_epi32(c0, c1);
+	__m128i c23hi = _mm_unpackhi_epi32(c2, c3);
+	const __m128i plane0 = _mm_unpacklo_epi64(c01lo, c23lo);
+	const __m128i plane1 = _mm_unpackhi_epi64(c01lo, c23lo);
+	const __m128i plane2 = _mm_unpacklo_epi64(c01hi, c23hi);
+	const __m128i plane3 = _mm_unpackhi_epi64(c01hi, c23hi);
+
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m128i index = ExpandNibbles(indexed);
+		__m128i p0 = _mm_shuffle_epi8(plane0, index);
+		__m128i p1 = _mm_shuffle_epi8(plane1, index);
+		__m128i p2 = _mm_shuffle_epi8(plane2, index);
+		__m128i p3 = _mm_shuffle_epi8(plane3, index);
+		__m128i p01lo = _mm_unpacklo_epi8(p0, p1);
+		__m128i p23lo = _mm_unpacklo_epi8(p2, p3);
+		__m128i p01hi = _mm_unpackhi_epi8(p0, p1);
+		__m128i p23hi = _mm_unpackhi_epi8(p2, p3);
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_unpacklo_epi16(p01lo, p23lo));
+		_mm_storeu_si128((__m128i *)(dest + i + 4), _mm_unpackhi_epi16(p01lo, p23lo));
+		_mm_storeu_si128((__m128i *)(dest + i + 8), _mm_unpacklo_epi16(p01hi, p23hi));
+		_mm_storeu_si128((__m128i *)(dest + i + 12), _mm_unpackhi_epi16(p01hi, p23hi));
+		indexed += 8;
+	}
+	if (i < length)
+		DeIndexTexture4Simple32Basic(dest + i, indexed, length - i, clut);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static void DeIndexTexture8Simple32AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	// A 256 entry clut is too big for shuffles, but gather handles it nicely.
+	int i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indexed + i)));
+		_mm256_storeu_si256((__m256i *)(dest + i), _mm256_i32gather_epi32((const int *)clut, index, 4));
+	}
+	if (i < length)
+		DeIndexTexture8Simple32Basic(dest + i, indexed + i, length - i, clut);
+}
+#endif
+
+#if !PPSSPP_ARCH(ARM64) && !defined(_M_SSE)
+QuickTexHashFunc DoQuickTexHash = &QuickTexHashBasic;
+QuickTexHashFunc StableQuickTexHash = &QuickTexHashNonSSE;
+UnswizzleTex16Func DoUnswizzleTex16 = &DoUnswizzleTex16Basic;
+#endif
+
+DecodeDXT1BlockFunc DecodeDXT1Block = &DecodeDXT1BlockBasic;
+DecodeDXT3BlockFunc DecodeDXT3Block = &DecodeDXT3BlockBasic;
+DecodeDXT5BlockFunc DecodeDXT5Block = &DecodeDXT5BlockBasic;
+DeIndexTexture4Simple16Func DeIndexTexture4Simple16 = &DeIndexTexture4Simple16Basic;
+DeIndexTexture4Simple32Func DeIndexTexture4Simple32 = &DeIndexTexture4Simple32Basic;
+DeIndexTexture8Simple32Func DeIndexTexture8Simple32 = &DeIndexTexture8Simple32Basic;
+
+// This has to be done after CPUDetect has done its magic.
+void SetupTextureDecoder() {
+#if PPSSPP_ARCH(ARM_NEON) && !PPSSPP_ARCH(ARM64)
+	if (cpu_info.bNEON) {
+		DoQuickTexHash = &QuickTexHashNEON;
+		StableQuickTexHash = &QuickTexHashNEON;
+		DoUnswizzleTex16 = &DoUnswizzleTex16NEON;
+	}
+#endif
+
+#if PPSSPP_ARCH(ARM_NEON)
+	if (cpu_info.bNEON) {
+		DecodeDXT1Block = &DecodeDXT1BlockNEON;
+		DecodeDXT3Block = &DecodeDXT3BlockNEON;
+		DecodeDXT5Block = &DecodeDXT5BlockNEON;
+		DeIndexTexture4Simple16 = &DeIndexTexture4Simple16NEON;
+		DeIndexTexture4Simple32 = &DeIndexTexture4Simple32NEON;
+	}
+#elif defined(_M_SSE)
+	if (cpu_info.bSSSE3) {
+		InitDXTLineShuffle();
+		DecodeDXT1Block = &DecodeDXT1BlockSSSE3;
+		DecodeDXT3Block = &DecodeDXT3BlockSSSE3;
+		DecodeDXT5Block = &DecodeDXT5BlockSSSE3;
+		DeIndexTexture4Simple16 = &DeIndexTexture4Simple16SSSE3;
+		DeIndexTexture4Simple32 = &DeIndexTexture4Simple32SSSE3;
+	}
+	if (cpu_info.bAVX2) {
+		DeIndexTexture8Simple32 = &DeIndexTexture8Simple32AVX2;
+	}
+#endif
 }
 
 #ifdef _M_SSE
@@ -88,9 +88,33 @@ struct DXT5Block {
 	u8 alpha1; u8 alpha2;
 };
 
-void DecodeDXT1Block(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha);
-void DecodeDXT3Block(u32 *dst, const DXT3Block *src, int pitch, int height);
-void DecodeDXT5Block(u32 *dst, const DXT5Block *src, int pitch, int height);
+// Palette and alpha table setup shared by the scalar and vectorized DXT decoders.
+void DecodeDXTColors(u32 colors[4], const DXT1Block *src, bool ignore1bitAlpha);
+void DecodeDXT5Alpha(u8 alpha[8], const DXT5Block *src);
+
+void DecodeDXT1BlockBasic(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha);
+void DecodeDXT3BlockBasic(u32 *dst, const DXT3Block *src, int pitch, int height);
+void DecodeDXT5BlockBasic(u32 *dst, const DXT5Block *src, int pitch, int height);
+
+typedef void (*DecodeDXT1BlockFunc)(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha);
+typedef void (*DecodeDXT3BlockFunc)(u32 *dst, const DXT3Block *src, int pitch, int height);
+typedef void (*DecodeDXT5BlockFunc)(u32 *dst, const DXT5Block *src, int pitch, int height);
+extern DecodeDXT1BlockFunc DecodeDXT1Block;
+extern DecodeDXT3BlockFunc DecodeDXT3Block;
+extern DecodeDXT5BlockFunc DecodeDXT5Block;
+
+// These only handle a simple clut index (no shift, mask, or offset), which is by far the common case.
+// CLUT4 lengths are in pixels and always processed in pairs, like DeIndexTexture4().
+void DeIndexTexture4Simple16Basic(u16 *dest, const u8 *indexed, int length, const u16 *clut);
+void DeIndexTexture4Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+void DeIndexTexture8Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+
+typedef void (*DeIndexTexture4Simple16Func)(u16 *dest, const u8 *indexed, int length, const u16 *clut);
+typedef void (*DeIndexTexture4Simple32Func)(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+typedef void (*DeIndexTexture8Simple32Func)(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+extern DeIndexTexture4Simple16Func DeIndexTexture4Simple16;
+extern DeIndexTexture4Simple32Func DeIndexTexture4Simple32;
+extern DeIndexTexture8Simple32Func DeIndexTexture8Simple32;
 
 uint32_t GetDXT1Texel(const DXT1Block *src, int x, int y);
 uint32_t GetDXT3Texel(const DXT3Block *src, int x, int y);
@@ -117,13 +141,34 @@ static const u8 textureBitsPerPixel[16] = {
 
 u32 GetTextureBufw(int level, u32 texaddr, GETextureFormat format);
 
+// Overloads so the templates below pick up the runtime selected kernels where one exists.
+inline bool DeIndexTextureSimple(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	DeIndexTexture8Simple32(dest, indexed, length, clut);
+	return true;
+}
+
+template <typename IndexT, typename ClutT>
+inline bool DeIndexTextureSimple(ClutT *dest, const IndexT *indexed, int length, const ClutT *clut) {
+	return false;
+}
+
+inline void DeIndexTexture4Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	DeIndexTexture4Simple16(dest, indexed, length, clut);
+}
+
+inline void DeIndexTexture4Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	DeIndexTexture4Simple32(dest, indexed, length, clut);
+}
+
 template <typename IndexT, typename ClutT>
 inline void DeIndexTexture(ClutT *dest, const IndexT *indexed, int length, const ClutT *clut) {
 	// Usually, there is no special offset, mask, or shift.
 	const bool nakedIndex = gstate.isClutIndexSimple();
 
 	if (nakedIndex) {
-		if (sizeof(IndexT) == 1) {
+		if (DeIndexTextureSimple(dest, indexed, length, clut)) {
+			return;
+		} else if (sizeof(IndexT) == 1) {
 			for (int i = 0; i < length; ++i) {
 				*dest++ = clut[*indexed++];
 			}
@@ -151,11 +196,7 @@ inline void DeIndexTexture4(ClutT *dest, const u8 *indexed, int length, const Cl
 	const bool nakedIndex = gstate.isClutIndexSimple();
 
 	if (nakedIndex) {
-		for (int i = 0; i < length; i += 2) {
-			u8 index = *indexed++;
-			dest[i + 0] = clut[(index >> 0) & 0xf];
-			dest[i + 1] = clut[(index >> 4) & 0xf];
-		}
+		DeIndexTexture4Simple(dest, indexed, length, clut);
 	} else {
 		for (int i = 0; i < length; i += 2) {
 			u8 index = *indexed++;
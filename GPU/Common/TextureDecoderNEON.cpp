@@ -292,4 +292,112 @@ CheckAlphaResult CheckAlphaRGBA5551NEON(const u32 *pixelData, int stride, int w,
 	return CHECKALPHA_FULL;
 }
 
+// 16 byte table lookup.  Out of range indices give zero on both ARMv7 and ARM64.
+static inline uint8x16_t LookupTable16NEON(uint8x16_t table, uint8x16_t index) {
+#if PPSSPP_ARCH(ARM64)
+	return vqtbl1q_u8(table, index);
+#else
+	uint8x8x2_t t;
+	t.val[0] = vget_low_u8(table);
+	t.val[1] = vget_high_u8(table);
+	return vcombine_u8(vtbl2_u8(t, vget_low_u8(index)), vtbl2_u8(t, vget_high_u8(index)));
+#endif
+}
+
+alignas(16) static const s32 DXTColorShifts[4] = { 0, -2, -4, -6 };
+alignas(16) static const s32 DXT3AlphaShifts[4] = { 28, 24, 20, 16 };
+alignas(16) static const s32 DXT5AlphaShifts[4] = { 0, -3, -6, -9 };
+
+// Builds the byte shuffle for one DXT line: lane x picks 32-bit color (line >> 2x) & 3.
+static inline uint8x16_t DXTLineShuffleNEON(u8 line) {
+	uint32x4_t index = vandq_u32(vshlq_u32(vdupq_n_u32(line), vld1q_s32(DXTColorShifts)), vdupq_n_u32(3));
+	return vreinterpretq_u8_u32(vmlaq_u32(vdupq_n_u32(0x03020100), index, vdupq_n_u32(0x04040404)));
+}
+
+void DecodeDXT1BlockNEON(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha) {
+	u32 colors[4];
+	DecodeDXTColors(colors, src, ignore1bitAlpha);
+	const uint8x16_t palette = vreinterpretq_u8_u32(vld1q_u32(colors));
+	for (int y = 0; y < height; y++) {
+		vst1q_u8((u8 *)dst, LookupTable16NEON(palette, DXTLineShuffleNEON(src->lines[y])));
+		dst += pitch;
+	}
+}
+
+void DecodeDXT3BlockNEON(u32 *dst, const DXT3Block *src, int pitch, int height) {
+	u32 colors[4];
+	DecodeDXTColors(colors, &src->color, true);
+	const uint8x16_t palette = vreinterpretq_u8_u32(vld1q_u32(colors));
+	const int32x4_t alphaShifts = vld1q_s32(DXT3AlphaShifts);
+	const uint32x4_t alphaMask = vdupq_n_u32(0xF0000000);
+	for (int y = 0; y < height; y++) {
+		uint32x4_t color = vreinterpretq_u32_u8(LookupTable16NEON(palette, DXTLineShuffleNEON(src->color.lines[y])));
+		uint32x4_t alpha = vandq_u32(vshlq_u32(vdupq_n_u32(src->alphaLines[y]), alphaShifts), alphaMask);
+		vst1q_u32(dst, vorrq_u32(color, alpha));
+		dst += pitch;
+	}
+}
+
+void DecodeDXT5BlockNEON(u32 *dst, const DXT5Block *src, int pitch, int height) {
+	u32 colors[4];
+	u8 alpha[8];
+	DecodeDXTColors(colors, &src->color, true);
+	DecodeDXT5Alpha(alpha, src);
+	const uint8x16_t palette = vreinterpretq_u8_u32(vld1q_u32(colors));
+	const uint8x16_t alphaTable = vcombine_u8(vld1_u8(alpha), vdup_n_u8(0));
+	const int32x4_t alphaShifts = vld1q_s32(DXT5AlphaShifts);
+
+	u64 alphadata = ((u64)(u16)src->alphadata1 << 32) | (u32)src->alphadata2;
+	for (int y = 0; y < height; y++) {
+		uint32x4_t color = vreinterpretq_u32_u8(LookupTable16NEON(palette, DXTLineShuffleNEON(src->color.lines[y])));
+		// Each alpha index goes in the top byte of its lane, with out of range (zero) bytes below.
+		uint32x4_t index = vandq_u32(vshlq_u32(vdupq_n_u32((u32)alphadata), alphaShifts), vdupq_n_u32(7));
+		uint32x4_t shuffle = vorrq_u32(vshlq_n_u32(index, 24), vdupq_n_u32(0x00808080));
+		uint32x4_t a = vreinterpretq_u32_u8(LookupTable16NEON(alphaTable, vreinterpretq_u8_u32(shuffle)));
+		vst1q_u32(dst, vorrq_u32(color, a));
+		alphadata >>= 12;
+		dst += pitch;
+	}
+}
+
+// Splits 16 nibble indices (8 bytes) into one byte each, in pixel order.
+static inline uint8x16_t ExpandNibblesNEON(const u8 *indexed) {
+	uint8x8_t in = vld1_u8(indexed);
+	uint8x8x2_t zipped = vzip_u8(vand_u8(in, vdup_n_u8(0x0F)), vshr_n_u8(in, 4));
+	return vcombine_u8(zipped.val[0], zipped.val[1]);
+}
+
+void DeIndexTexture4Simple16NEON(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	// vld2/vst2 conveniently split and rejoin the low and high byte planes of the clut.
+	const uint8x16x2_t planes = vld2q_u8((const u8 *)clut);
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		uint8x16_t index = ExpandNibblesNEON(indexed);
+		uint8x16x2_t result;
+		result.val[0] = LookupTable16NEON(planes.val[0], index);
+		result.val[1] = LookupTable16NEON(planes.val[1], index);
+		vst2q_u8((u8 *)(dest + i), result);
+		indexed += 8;
+	}
+	if (i < length)
+		DeIndexTexture4Simple16Basic(dest + i, indexed, length - i, clut);
+}
+
+void DeIndexTexture4Simple32NEON(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	const uint8x16x4_t planes = vld4q_u8((const u8 *)clut);
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		uint8x16_t index = ExpandNibblesNEON(indexed);
+		uint8x16x4_t result;
+		result.val[0] = LookupTable16NEON(planes.val[0], index);
+		result.val[1] = LookupTable16NEON(planes.val[1], index);
+		result.val[2] = LookupTable16NEON(planes.val[2], index);
+		result.val[3] = LookupTable16NEON(planes.val[3], index);
+		vst4q_u8((u8 *)(dest + i), result);
+		indexed += 8;
+	}
+	if (i < length)
+		DeIndexTexture4Simple32Basic(dest + i, indexed, length - i, clut);
+}
+
 #endif
@@ -17,6 +17,10 @@
 
 #include "GPU/Common/TextureDecoder.h"
 
+struct DXT1Block;
+struct DXT3Block;
+struct DXT5Block;
+
 u32 QuickTexHashNEON(const void *checkp, u32 size);
 void DoUnswizzleTex16NEON(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 pitch);
 
@@ -25,3 +29,9 @@ CheckAlphaResult CheckAlphaABGR4444NEON(const u32 *pixelData, int stride, int w,
 CheckAlphaResult CheckAlphaABGR1555NEON(const u32 *pixelData, int stride, int w, int h);
 CheckAlphaResult CheckAlphaRGBA4444NEON(const u32 *pixelData, int stride, int w, int h);
 CheckAlphaResult CheckAlphaRGBA5551NEON(const u32 *pixelData, int stride, int w, int h);
+
+void DecodeDXT1BlockNEON(u32 *dst, const DXT1Block *src, int pitch, int height, bool ignore1bitAlpha);
+void DecodeDXT3BlockNEON(u32 *dst, const DXT3Block *src, int pitch, int height);
+void DecodeDXT5BlockNEON(u32 *dst, const DXT5Block *src, int pitch, int height);
+void DeIndexTexture4Simple16NEON(u16 *dest, const u8 *indexed, int length, const u16 *clut);
+void DeIndexTexture4Simple32NEON(u32 *dest, const u8 *indexed, int length, const u32 *clut);
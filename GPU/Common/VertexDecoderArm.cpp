@@ -37,13 +37,13 @@ extern void DisassembleArm(const u8 *data, int size);
 bool NEONSkinning = false;
 bool NEONMorphing = false;
 
-// Used only in non-NEON mode.
-alignas(16) static float skinMatrix[12];
-
-// Will be used only in NEON mode.
-alignas(16) static float bones[16 * 8];  // First two are kept in registers
 alignas(16) static float boneMask[4] = {1.0f, 1.0f, 1.0f, 0.0f};
 
+// When skinning, scratch space is kept on the stack so several threads can decode at once.
+// In NEON mode it holds the 4x4 bone matrices (first two are kept in registers), otherwise the skin matrix.
+// The first word is a 16-byte aligned pointer to it, since the stack is only 8-byte aligned.
+static const u32 STACK_BONES_ALLOC = 16 * 8 * 4 + 32;
+
 // NEON register allocation:
 // Q0: Texture scaling parameters
 // Q1: Temp storage
@@ -53,7 +53,7 @@ alignas(16) static float boneMask[4] = {1.0f, 1.0f, 1.0f, 0.0f};
 // When skinning, we'll use Q4-Q7 as the "matrix accumulator".
 // First two matrices will be preloaded into Q8-Q11 and Q12-Q15 to reduce
 // memory bandwidth requirements.
-// The rest will be dumped to bones as on x86.
+// The rest will be dumped to the stack as on x86.
 //
 // When morphing, we never skin.  So we're free to use Q4+.
 // Q4 is for color shift values, and Q5 is a secondary multipler inside the morph.
@@ -202,6 +202,12 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	if (NEONSkinning || NEONMorphing) {
 		VPUSH(D8, 8);
 	}
+	if (dec.weighttype) {
+		SUBI2R(R_SP, R_SP, STACK_BONES_ALLOC, scratchReg);
+		ADDI2R(tempReg2, R_SP, 4 + 15, scratchReg);
+		BIC(tempReg2, tempReg2, 15);
+		STR(tempReg2, R_SP, 0);
+	}
 
 	// Keep the scale/offset in a few fp registers if we need it.
 	if (prescaleStep) {
@@ -234,7 +240,7 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	if (NEONSkinning && dec.weighttype && g_Config.bSoftwareSkinning) {
 		// Copying from R3 to R4
 		MOVP2R(R3, gstate.boneMatrix);
-		MOVP2R(R4, bones);
+		LDR(R4, R_SP, 0);
 		MOVP2R(R5, boneMask);
 		VLD1(F_32, Q3, R5, 2, ALIGN_128);
 		for (int i = 0; i < dec.nweights; i++) {
@@ -305,6 +311,9 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		SetCC(CC_AL);
 	}
 
+	if (dec.weighttype) {
+		ADDI2R(R_SP, R_SP, STACK_BONES_ALLOC, scratchReg);
+	}
 	if (NEONSkinning || NEONMorphing) {
 		VPOP(D8, 8);
 	}
@@ -383,7 +392,8 @@ void VertexDecoderJitCache::Jit_ApplyWeights() {
 		// We construct a matrix in Q4-Q7
 		// We can use Q1 as temp.
 		if (dec_->nweights >= 2) {
-			MOVP2R(scratchReg, bones + 16 * 2);
+			LDR(scratchReg, R_SP, 0);
+			ADD(scratchReg, scratchReg, 16 * 2 * 4);
 		}
 		for (int i = 0; i < dec_->nweights; i++) {
 			switch (i) {
@@ -435,7 +445,7 @@ void VertexDecoderJitCache::Jit_ApplyWeights() {
 			}
 		}
 	} else {
-		MOVP2R(tempReg2, skinMatrix);
+		LDR(tempReg2, R_SP, 0);
 		// This approach saves a few stores but accesses the matrices in a more
 		// sparse order.
 		const float *bone = &gstate.boneMatrix[0];
@@ -1327,7 +1337,7 @@ void VertexDecoderJitCache::Jit_WriteMatrixMul(int outOff, bool pos) {
 		_dbg_assert_msg_(fpScratchReg + 1 == fpScratchReg2, "VertexDecoder fpScratchRegs must be in order.");
 		_dbg_assert_msg_(fpScratchReg2 + 1 == fpScratchReg3, "VertexDecoder fpScratchRegs must be in order.");
 
-		MOVP2R(tempReg1, skinMatrix);
+		LDR(tempReg1, R_SP, 0);
 		VLDMIA(tempReg1, true, fpScratchReg, 3);
 		for (int i = 0; i < 3; i++) {
 			VMUL(acc[i], ARMReg(fpScratchReg + i), src[0]);
@@ -27,8 +27,10 @@
 #include "GPU/GPUState.h"
 #include "GPU/Common/VertexDecoderCommon.h"
 
-alignas(16) static float bones[16 * 8];  // First four are kept in registers
 alignas(16) static float boneMask[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+// When skinning, the 4x4 bone matrices are kept on the stack so several threads can decode at once.
+// First four are kept in registers.
+static const u32 STACK_BONES_SIZE = 16 * 8 * 4;
 
 static const float by128 = 1.0f / 128.0f;
 static const float by32768 = 1.0f / 32768.0f;
@@ -173,6 +175,9 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	uint64_t regs_to_save = Arm64Gen::ALL_CALLEE_SAVED;
 	uint64_t regs_to_save_fp = Arm64Gen::ALL_CALLEE_SAVED_FP;
 	fp.ABI_PushRegisters(regs_to_save, regs_to_save_fp);
+	if (dec.weighttype) {
+		SUB(SP, SP, STACK_BONES_SIZE);
+	}
 
 	// Keep the scale/offset in a few fp registers if we need it.
 	if (prescaleStep) {
@@ -193,7 +198,7 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	if (dec.weighttype && g_Config.bSoftwareSkinning) {
 		// Copying from R3 to R4
 		MOVP2R(X3, gstate.boneMatrix);
-		MOVP2R(X4, bones);
+		ADD(X4, SP, 0);
 		MOVP2R(X5, boneMask);
 		fp.LDR(128, INDEX_UNSIGNED, Q3, X5, 0);
 		for (int i = 0; i < dec.nweights; i++) {
@@ -272,6 +277,9 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		STRH(INDEX_UNSIGNED, boundsMaxVReg, scratchReg64, offsetof(KnownVertexBounds, maxV));
 	}
 
+	if (dec.weighttype) {
+		ADD(SP, SP, STACK_BONES_SIZE);
+	}
 	fp.ABI_PopRegisters(regs_to_save, regs_to_save_fp);
 
 	RET();
@@ -308,7 +316,7 @@ bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
 void VertexDecoderJitCache::Jit_ApplyWeights() {
 	// We construct a matrix in Q4-Q7
 	if (dec_->nweights >= 4) {
-		MOVP2R(scratchReg64, bones + 16 * 4);
+		ADD(scratchReg64, SP, 16 * 4 * 4);
 	}
 	for (int i = 0; i < dec_->nweights; i++) {
 		switch (i) {
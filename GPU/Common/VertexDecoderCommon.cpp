@@ -1306,6 +1306,12 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, int indexLowe
 	}
 }
 
+bool VertexDecoder::IsReentrant() const {
+	// The interpreter keeps its position in decoded_ and ptr_, and skins through a static matrix.
+	// The jits keep their skinning scratch on the stack.
+	return jitted_ != nullptr;
+}
+
 static const char *posnames[4] = { "?", "s8", "s16", "f" };
 static const char *nrmnames[4] = { "", "s8", "s16", "f" };
 static const char *tcnames[4] = { "", "u8", "u16", "f" };
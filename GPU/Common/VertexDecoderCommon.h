@@ -453,6 +453,8 @@ class VertexDecoder {
 	const DecVtxFormat &GetDecVtxFmt() { return decFmt; }
 
 	void DecodeVerts(u8 *decoded, const void *verts, int indexLowerBound, int indexUpperBound) const;
+	// True if DecodeVerts can be called from several threads at once (with the same gstate_c.uv.)
+	bool IsReentrant() const;
 
 	bool hasColor() const { return col != 0; }
 	bool hasTexcoord() const { return tc != 0; }
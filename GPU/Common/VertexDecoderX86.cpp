@@ -26,12 +26,20 @@
 #include "GPU/GPUState.h"
 #include "GPU/Common/VertexDecoderCommon.h"
 
-// We start out by converting the active matrices into 4x4 which are easier to multiply with
-// using SSE / NEON and store them here.
-alignas(16) static float bones[16 * 8];
-
 using namespace Gen;
 
+#if PPSSPP_ARCH(X86)
+static const int STACK_FIXED_ALLOC = 64;
+#else
+// This will align the stack properly to 16 bytes (the call of this function pushed RIP, which is 8 bytes).
+static const int STACK_FIXED_ALLOC = 96 + 8;
+#endif
+// When skinning, we start out by converting the active matrices into 4x4 which are easier to multiply
+// with using SSE.  They're stored on the stack after the fixed area, so several threads can decode at once.
+// The first slot holds a 16-byte aligned pointer to them, since 32-bit x86 doesn't align the stack.
+static const int STACK_BONES_PTR = STACK_FIXED_ALLOC;
+static const int STACK_BONES_ALLOC = 16 * 8 * 4 + 32;
+
 alignas(16) static const float by128[4] = {
 	1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f
 };
@@ -179,17 +187,14 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	MOV(32, R(srcReg), MDisp(ESP, 16 + offset + 0));
 	MOV(32, R(dstReg), MDisp(ESP, 16 + offset + 4));
 	MOV(32, R(counterReg), MDisp(ESP, 16 + offset + 8));
-
-	const uint8_t STACK_FIXED_ALLOC = 64;
 #else
 	// Parameters automatically fall into place.
-
-	// This will align the stack properly to 16 bytes (the call of this function pushed RIP, which is 8 bytes).
-	const uint8_t STACK_FIXED_ALLOC = 96 + 8;
 #endif
 
 	// Allocate temporary storage on the stack.
-	SUB(PTRBITS, R(ESP), Imm8(STACK_FIXED_ALLOC));
+	const bool skinning = dec.weighttype != 0;
+	const int stackAlloc = STACK_FIXED_ALLOC + (skinning ? STACK_BONES_ALLOC : 0);
+	SUB(PTRBITS, R(ESP), Imm32(stackAlloc));
 	// Save XMM4/XMM5 which apparently can be problematic?
 	// Actually, if they are, it must be a compiler bug because they SHOULD be ok.
 	// So I won't bother.
@@ -217,6 +222,12 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		}
 	}
 
+	if (skinning) {
+		LEA(PTRBITS, tempReg2, MDisp(ESP, STACK_BONES_PTR + 8 + 15));
+		AND(PTRBITS, R(tempReg2), Imm32(~15));
+		MOV(PTRBITS, MDisp(ESP, STACK_BONES_PTR), R(tempReg2));
+	}
+
 	// Add code to convert matrices to 4x4.
 	// Later we might want to do this when the matrices are loaded instead.
 	if (dec.weighttype && g_Config.bSoftwareSkinning) {
@@ -225,7 +236,6 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		MOV(PTRBITS, R(tempReg1), ImmPtr(&aOne));
 		MOVUPS(XMM5, MatR(tempReg1));
 		MOV(PTRBITS, R(tempReg1), ImmPtr(gstate.boneMatrix));
-		MOV(PTRBITS, R(tempReg2), ImmPtr(bones));
 		for (int i = 0; i < dec.nweights; i++) {
 			MOVUPS(XMM0, MDisp(tempReg1, (12 * i) * 4));
 			MOVUPS(XMM1, MDisp(tempReg1, (12 * i + 3) * 4));
@@ -280,7 +290,7 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	MOVUPS(XMM8, MDisp(ESP, 64));
 	MOVUPS(XMM9, MDisp(ESP, 80));
 #endif
-	ADD(PTRBITS, R(ESP), Imm8(STACK_FIXED_ALLOC));
+	ADD(PTRBITS, R(ESP), Imm32(stackAlloc));
 
 #if PPSSPP_ARCH(X86)
 	// Restore register values
@@ -467,7 +477,7 @@ void VertexDecoderJitCache::Jit_WeightsFloat() {
 }
 
 void VertexDecoderJitCache::Jit_WeightsU8Skin() {
-	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
+	MOV(PTRBITS, R(tempReg2), MDisp(ESP, STACK_BONES_PTR));
 
 #if PPSSPP_ARCH(AMD64)
 	if (dec_->nweights > 4) {
@@ -577,7 +587,7 @@ void VertexDecoderJitCache::Jit_WeightsU8Skin() {
 }
 
 void VertexDecoderJitCache::Jit_WeightsU16Skin() {
-	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
+	MOV(PTRBITS, R(tempReg2), MDisp(ESP, STACK_BONES_PTR));
 
 #if PPSSPP_ARCH(AMD64)
 	if (dec_->nweights > 6) {
@@ -691,7 +701,7 @@ void VertexDecoderJitCache::Jit_WeightsU16Skin() {
 }
 
 void VertexDecoderJitCache::Jit_WeightsFloatSkin() {
-	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
+	MOV(PTRBITS, R(tempReg2), MDisp(ESP, STACK_BONES_PTR));
 	for (int j = 0; j < dec_->nweights; j++) {
 		MOVSS(XMM1, MDisp(srcReg, dec_->weightoff + j * 4));
 		SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
@@ -25,6 +25,7 @@
 #include "Common/Profiler/Profiler.h"
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -35,6 +36,7 @@
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/System.h"
+#include "GPU/GPU.h"
 #include "GPU/GPUInterface.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -47,8 +49,16 @@ namespace GPURecord {
 static std::string lastExecFilename;
 static std::vector<Command> lastExecCommands;
 static std::vector<u8> lastExecPushbuf;
+// End index (exclusive) into lastExecCommands of each recorded frame.
+static std::vector<size_t> lastExecFrameEnds;
+static size_t lastExecFrame;
 static std::mutex executeLock;
 
+static int benchmarkIterations;
+static int benchmarkRuns;
+static std::vector<ReplayFrameStats> benchmarkFrames;
+static std::string benchmarkBackendStats;
+
 // This class maps pushbuffer (dump data) sections to PSP memory.
 // Dumps can be larger than available PSP memory, because they include generated data too.
 //
@@ -282,7 +292,7 @@ class DumpExecute {
 	}
 	~DumpExecute();
 
-	bool Run();
+	bool Run(size_t begin, size_t end);
 
 private:
 	void SyncStall();
@@ -564,8 +574,9 @@ DumpExecute::~DumpExecute() {
 	mapping_.Reset();
 }
 
-bool DumpExecute::Run() {
-	for (const Command &cmd : commands_) {
+bool DumpExecute::Run(size_t begin, size_t end) {
+	for (size_t i = begin; i < end; ++i) {
+		const Command &cmd = commands_[i];
 		switch (cmd.type) {
 		case CommandType::INIT:
 			Init(cmd.ptr, cmd.sz);
@@ -667,6 +678,52 @@ static void ReplayStop() {
 	lastExecFilename.clear();
 	lastExecCommands.clear();
 	lastExecPushbuf.clear();
+	lastExecFrameEnds.clear();
+	lastExecFrame = 0;
+}
+
+static bool ReadChunk(u32 fp, uint32_t version, bool *empty) {
+	u32 sz = 0;
+	u32 bufsz = 0;
+	*empty = false;
+	if (pspFileSystem.ReadFile(fp, (u8 *)&sz, sizeof(sz)) != sizeof(sz))
+		return false;
+	if (pspFileSystem.ReadFile(fp, (u8 *)&bufsz, sizeof(bufsz)) != sizeof(bufsz))
+		return false;
+	if (sz == 0) {
+		*empty = true;
+		return true;
+	}
+
+	size_t cmdStart = lastExecCommands.size();
+	size_t bufStart = lastExecPushbuf.size();
+	lastExecCommands.resize(cmdStart + sz);
+	lastExecPushbuf.resize(bufStart + bufsz);
+
+	bool success = ReadCompressed(fp, lastExecCommands.data() + cmdStart, sizeof(Command) * sz, version);
+	success = success && ReadCompressed(fp, lastExecPushbuf.data() + bufStart, bufsz, version);
+	return success;
+}
+
+static void ComputeFrameEnds() {
+	// A frame ends at a display command, as long as it did something besides init.
+	lastExecFrameEnds.clear();
+	bool hasWork = false;
+	for (size_t i = 0; i < lastExecCommands.size(); ++i) {
+		CommandType type = lastExecCommands[i].type;
+		if (type == CommandType::DISPLAY) {
+			if (hasWork)
+				lastExecFrameEnds.push_back(i + 1);
+			hasWork = false;
+		} else if (type != CommandType::INIT) {
+			hasWork = true;
+		}
+	}
+	if (hasWork || lastExecFrameEnds.empty())
+		lastExecFrameEnds.push_back(lastExecCommands.size());
+	else
+		lastExecFrameEnds.back() = lastExecCommands.size();
+	lastExecFrame = 0;
 }
 
 bool RunMountedReplay(const std::string &filename) {
@@ -695,30 +752,94 @@ bool RunMountedReplay(const std::string &filename) {
 			g_paramSFO.SetValue("DISC_ID", std::string(header.gameID, gameIDLength), (int)sizeof(header.gameID));
 		}
 
-		u32 sz = 0;
-		pspFileSystem.ReadFile(fp, (u8 *)&sz, sizeof(sz));
-		u32 bufsz = 0;
-		pspFileSystem.ReadFile(fp, (u8 *)&bufsz, sizeof(bufsz));
-
-		lastExecCommands.resize(sz);
-		lastExecPushbuf.resize(bufsz);
+		lastExecCommands.clear();
+		lastExecPushbuf.clear();
 
 		bool truncated = false;
-		truncated = truncated || !ReadCompressed(fp, lastExecCommands.data(), sizeof(Command) * sz, header.version);
-		truncated = truncated || !ReadCompressed(fp, lastExecPushbuf.data(), bufsz, header.version);
+		bool empty = false;
+		if (header.version < 6) {
+			truncated = !ReadChunk(fp, header.version, &empty);
+		} else {
+			// Version 6 is a series of chunks, ending with an empty one.
+			while (!truncated && !empty)
+				truncated = !ReadChunk(fp, header.version, &empty);
+		}
 
 		pspFileSystem.CloseFile(fp);
 
-		if (truncated) {
+		if (truncated && lastExecCommands.empty()) {
 			ERROR_LOG(SYSTEM, "Truncated GE dump");
 			return false;
+		} else if (truncated) {
+			// Could've been cut off while recording, let's play what we have.
+			WARN_LOG(SYSTEM, "Truncated GE dump, playing %d commands", (int)lastExecCommands.size());
 		}
 
 		lastExecFilename = filename;
+		ComputeFrameEnds();
 	}
 
+	// Each call plays a single recorded frame, starting over after the last one.
+	if (lastExecFrame >= lastExecFrameEnds.size())
+		lastExecFrame = 0;
+	size_t begin = lastExecFrame == 0 ? 0 : lastExecFrameEnds[lastExecFrame - 1];
+	size_t end = lastExecFrameEnds[lastExecFrame];
+	lastExecFrame++;
+
 	DumpExecute executor(lastExecPushbuf, lastExecCommands);
-	return executor.Run();
+	if (benchmarkIterations == 0)
+		return executor.Run(begin, end);
+
+	// The first pass loads textures, shaders, etc. so don't count it.
+	bool warmup = benchmarkRuns++ < (int)lastExecFrameEnds.size();
+	int drawCalls = gpuStats.numDrawCalls;
+	int vertices = gpuStats.numVertsSubmitted;
+	double start = time_now_d();
+	bool success = executor.Run(begin, end);
+	double elapsed = time_now_d() - start;
+
+	int target = benchmarkIterations * (int)lastExecFrameEnds.size();
+	if (!warmup && (int)benchmarkFrames.size() < target) {
+		benchmarkFrames.push_back(ReplayFrameStats{ elapsed, gpuStats.numDrawCalls - drawCalls, gpuStats.numVertsSubmitted - vertices });
+		if ((int)benchmarkFrames.size() == target) {
+			char stats[4096]{};
+			gpu->GetStats(stats, sizeof(stats));
+			benchmarkBackendStats = stats;
+		}
+	}
+	return success;
+}
+
+void SetReplayBenchmark(int iterations) {
+	std::lock_guard<std::mutex> guard(executeLock);
+	benchmarkIterations = iterations;
+	benchmarkRuns = 0;
+	benchmarkFrames.clear();
+	benchmarkBackendStats.clear();
+}
+
+int GetReplayBenchmarkRemaining() {
+	std::lock_guard<std::mutex> guard(executeLock);
+	int frames = std::max(1, (int)lastExecFrameEnds.size());
+	return benchmarkIterations * frames - (int)benchmarkFrames.size();
+}
+
+int GetReplayFramesRemaining() {
+	std::lock_guard<std::mutex> guard(executeLock);
+	if (lastExecFrameEnds.empty())
+		return 0;
+	return (int)lastExecFrameEnds.size() - (int)lastExecFrame;
+}
+
+std::vector<ReplayFrameStats> TakeReplayBenchmark(std::string *backendStats) {
+	std::lock_guard<std::mutex> guard(executeLock);
+	std::vector<ReplayFrameStats> frames;
+	frames.swap(benchmarkFrames);
+	if (backendStats)
+		*backendStats = benchmarkBackendStats;
+	benchmarkBackendStats.clear();
+	benchmarkRuns = 0;
+	return frames;
 }
 
 };
@@ -18,9 +18,27 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace GPURecord {
 
+// Plays the next frame of the dump, starting over after the last one.
 bool RunMountedReplay(const std::string &filename);
+// Frames left before the dump starts over.
+int GetReplayFramesRemaining();
+
+struct ReplayFrameStats {
+	double seconds;
+	int drawCalls;
+	int vertices;
+};
+
+// When set, replays are timed: the first pass is a warmup, and the next iterations are recorded.
+// Each iteration plays every frame in the dump.
+// Headless stops the replay once GetReplayBenchmarkRemaining() hits zero.
+void SetReplayBenchmark(int iterations);
+int GetReplayBenchmarkRemaining();
+// Returns the recorded frames and resets for the next dump.
+std::vector<ReplayFrameStats> TakeReplayBenchmark(std::string *backendStats);
 
 };
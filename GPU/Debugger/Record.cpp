@@ -17,9 +17,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <zstd.h>
@@ -27,6 +31,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/File/FileUtil.h"
 #include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
 
@@ -43,27 +48,73 @@
 #include "GPU/Common/VertexDecoderCommon.h"
 #include "GPU/Debugger/Record.h"
 #include "GPU/Debugger/RecordFormat.h"
+#include "ext/xxhash.h"
 
 namespace GPURecord {
 
-static bool active = false;
-static bool nextFrame = false;
+// Blobs are content addressed, so each vertex/texture/etc. buffer is stored once per recording.
+struct BlobKey {
+	XXH128_hash_t hash;
+	u32 sz;
+
+	bool operator ==(const BlobKey &other) const {
+		return hash.low64 == other.hash.low64 && hash.high64 == other.hash.high64 && sz == other.sz;
+	}
+};
+
+struct BlobKeyHash {
+	size_t operator ()(const BlobKey &key) const {
+		return (size_t)key.hash.low64;
+	}
+};
+
+// Frames are handed to the writer thread in chunks, with pushbuf ptrs relative to the whole file.
+struct RecordChunk {
+	std::vector<Command> commands;
+	std::vector<u8> pushbuf;
+};
+
+// Flush mid-frame if a single frame gets this large.
+static const size_t CHUNK_FLUSH_SIZE = 32 * 1024 * 1024;
+// Must be at least the largest alignment passed to EmitCommandWithRAM.
+static const size_t CHUNK_ALIGN = 16;
+
+static std::atomic<bool> active{ false };
+static std::atomic<bool> nextFrame{ false };
+// Set when the core stops, the GPU thread finishes the recording at its next frame.
+static std::atomic<bool> stopRequested{ false };
+static int framesToRecord = 1;
+static int framesRecorded = 0;
 static int flipLastAction = -1;
 static std::function<void(const Path &)> writeCallback;
 
 static std::vector<u8> pushbuf;
+// Size of all pushbuf data already handed to the writer.
+static u32 pushbufBase = 0;
 static std::vector<Command> commands;
 static std::vector<u32> lastRegisters;
-static std::vector<u32> lastTextures;
 static std::set<u32> lastRenderTargets;
+static std::unordered_map<BlobKey, u32, BlobKeyHash> blobs;
+// Set if draws were already flushed to the writer mid-frame.
+static bool frameHasDraws = false;
+
+static Path writeFilename;
+static FILE *writeFile = nullptr;
+static std::thread writeThread;
+static std::mutex writeLock;
+static std::condition_variable writeCond;
+static std::deque<RecordChunk> writeQueue;
+static bool writeDone = false;
+
+static bool HasDrawCommands();
 
 static void FlushRegisters() {
 	if (!lastRegisters.empty()) {
 		Command last{CommandType::REGISTERS};
-		last.ptr = (u32)pushbuf.size();
+		last.ptr = pushbufBase + (u32)pushbuf.size();
 		last.sz = (u32)(lastRegisters.size() * sizeof(u32));
 		pushbuf.resize(pushbuf.size() + last.sz);
-		memcpy(pushbuf.data() + last.ptr, lastRegisters.data(), last.sz);
+		memcpy(pushbuf.data() + last.ptr - pushbufBase, lastRegisters.data(), last.sz);
 		lastRegisters.clear();
 
 		commands.push_back(last);
@@ -90,21 +141,6 @@ static Path GenRecordingFilename() {
 	return dumpDir / StringFromFormat("%s_%04d.ppdmp", prefix.c_str(), 9999);
 }
 
-static void BeginRecording() {
-	active = true;
-	nextFrame = false;
-	lastTextures.clear();
-	lastRenderTargets.clear();
-	flipLastAction = gpuStats.numFlips;
-
-	u32 ptr = (u32)pushbuf.size();
-	u32 sz = 512 * 4;
-	pushbuf.resize(pushbuf.size() + sz);
-	gstate.Save((u32_le *)(pushbuf.data() + ptr));
-
-	commands.push_back({CommandType::INIT, sz, ptr});
-}
-
 static void WriteCompressed(FILE *fp, const void *p, size_t sz) {
 	size_t compressed_size = ZSTD_compressBound(sz);
 	u8 *compressed = new u8[compressed_size];
@@ -117,31 +153,117 @@ static void WriteCompressed(FILE *fp, const void *p, size_t sz) {
 	delete [] compressed;
 }
 
-static Path WriteRecording() {
+static void WriteChunk(FILE *fp, const RecordChunk &chunk) {
+	u32 sz = (u32)chunk.commands.size();
+	fwrite(&sz, sizeof(sz), 1, fp);
+	u32 bufsz = (u32)chunk.pushbuf.size();
+	fwrite(&bufsz, sizeof(bufsz), 1, fp);
+
+	WriteCompressed(fp, chunk.commands.data(), chunk.commands.size() * sizeof(Command));
+	WriteCompressed(fp, chunk.pushbuf.data(), bufsz);
+}
+
+static void WriteThreadFunc() {
+	SetCurrentThreadName("GPURecordWrite");
+
+	std::unique_lock<std::mutex> guard(writeLock);
+	while (true) {
+		writeCond.wait(guard, [] {
+			return writeDone || !writeQueue.empty();
+		});
+		if (writeQueue.empty())
+			break;
+
+		RecordChunk chunk = std::move(writeQueue.front());
+		writeQueue.pop_front();
+
+		// Compress without holding the lock, so the GPU thread can keep queueing.
+		guard.unlock();
+		WriteChunk(writeFile, chunk);
+		guard.lock();
+	}
+
+	// A chunk with no commands or data marks the end.
+	WriteChunk(writeFile, RecordChunk());
+	fclose(writeFile);
+	writeFile = nullptr;
+}
+
+static void FlushChunk() {
 	FlushRegisters();
+	if (commands.empty() && pushbuf.empty())
+		return;
+	if (HasDrawCommands())
+		frameHasDraws = true;
+	// Keep pushbufBase aligned, so alignment within the chunk matches the file.
+	if (pushbuf.size() & (CHUNK_ALIGN - 1))
+		pushbuf.resize((pushbuf.size() + CHUNK_ALIGN - 1) & ~(CHUNK_ALIGN - 1), 0);
+
+	RecordChunk chunk;
+	chunk.commands.swap(commands);
+	chunk.pushbuf.swap(pushbuf);
+	pushbufBase += (u32)chunk.pushbuf.size();
+
+	std::lock_guard<std::mutex> guard(writeLock);
+	writeQueue.push_back(std::move(chunk));
+	writeCond.notify_one();
+}
+
+static void EndWriteThread() {
+	if (!writeThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(writeLock);
+		writeDone = true;
+		writeCond.notify_one();
+	}
+	writeThread.join();
+}
 
-	const Path filename = GenRecordingFilename();
+static void StopRecordingRequest();
 
-	NOTICE_LOG(G3D, "Recording filename: %s", filename.c_str());
+static bool BeginRecording() {
+	writeFilename = GenRecordingFilename();
+	NOTICE_LOG(G3D, "Recording filename: %s", writeFilename.c_str());
+
+	writeFile = File::OpenCFile(writeFilename, "wb");
+	if (!writeFile) {
+		ERROR_LOG(G3D, "Unable to open GE dump for writing");
+		nextFrame = false;
+		return false;
+	}
 
-	FILE *fp = File::OpenCFile(filename, "wb");
 	Header header{};
 	strncpy(header.magic, HEADER_MAGIC, sizeof(header.magic));
 	header.version = VERSION;
 	strncpy(header.gameID, g_paramSFO.GetDiscID().c_str(), sizeof(header.gameID));
-	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(&header, sizeof(header), 1, writeFile);
 
-	u32 sz = (u32)commands.size();
-	fwrite(&sz, sizeof(sz), 1, fp);
-	u32 bufsz = (u32)pushbuf.size();
-	fwrite(&bufsz, sizeof(bufsz), 1, fp);
+	active = true;
+	nextFrame = false;
+	framesRecorded = 0;
+	frameHasDraws = false;
+	lastRenderTargets.clear();
+	blobs.clear();
+	commands.clear();
+	pushbuf.clear();
+	lastRegisters.clear();
+	pushbufBase = 0;
+	flipLastAction = gpuStats.numFlips;
 
-	WriteCompressed(fp, commands.data(), commands.size() * sizeof(Command));
-	WriteCompressed(fp, pushbuf.data(), bufsz);
+	writeDone = false;
+	writeQueue.clear();
+	writeThread = std::thread(&WriteThreadFunc);
+	Core_ListenStopRequest(&StopRecordingRequest);
 
-	fclose(fp);
+	u32 ptr = (u32)pushbuf.size();
+	u32 sz = 512 * 4;
+	pushbuf.resize(pushbuf.size() + sz);
+	gstate.Save((u32_le *)(pushbuf.data() + ptr));
 
-	return filename;
+	commands.push_back({CommandType::INIT, sz, pushbufBase + ptr});
+	return true;
 }
 
 static void GetVertDataSizes(int vcount, const void *indices, u32 &vbytes, u32 &ibytes) {
@@ -219,25 +341,33 @@ static const u8 *mymemmem(const u8 *haystack, size_t off, size_t hlen, const u8
 
 static Command EmitCommandWithRAM(CommandType t, const void *p, u32 sz, u32 align) {
 	FlushRegisters();
+	if (pushbuf.size() >= CHUNK_FLUSH_SIZE)
+		FlushChunk();
 
 	Command cmd{t, sz, 0};
 
 	if (sz) {
-		// If at all possible, try to find it already in the buffer.
+		// If we've stored this exact data before (this or any earlier frame), just point at it.
+		BlobKey key{ XXH3_128bits(p, sz), sz };
+		auto it = blobs.find(key);
+		if (it != blobs.end() && (it->second & (align - 1)) == 0) {
+			cmd.ptr = it->second;
+			commands.push_back(cmd);
+			return cmd;
+		}
+
+		// Otherwise, it's often a subset of something recent, like a range of a vertex buffer.
 		const u8 *prev = nullptr;
 		const size_t NEAR_WINDOW = std::max((int)sz * 2, 1024 * 10);
-		// Let's try nearby first... it will often be nearby.
-		if (pushbuf.size() > NEAR_WINDOW) {
-			prev = mymemmem(pushbuf.data(), pushbuf.size() - NEAR_WINDOW, pushbuf.size(), (const u8 *)p, sz, align);
-		}
-		if (!prev) {
-			prev = mymemmem(pushbuf.data(), 0, pushbuf.size(), (const u8 *)p, sz, align);
+		size_t start = pushbuf.size() > NEAR_WINDOW ? pushbuf.size() - NEAR_WINDOW : 0;
+		if (pushbuf.size() - start >= sz) {
+			prev = mymemmem(pushbuf.data(), start, pushbuf.size(), (const u8 *)p, sz, align);
 		}
 
 		if (prev) {
-			cmd.ptr = (u32)(prev - pushbuf.data());
+			cmd.ptr = pushbufBase + (u32)(prev - pushbuf.data());
 		} else {
-			cmd.ptr = (u32)pushbuf.size();
+			cmd.ptr = pushbufBase + (u32)pushbuf.size();
 			int pad = 0;
 			if (cmd.ptr & (align - 1)) {
 				pad = align - (cmd.ptr & (align - 1));
@@ -245,10 +375,11 @@ static Command EmitCommandWithRAM(CommandType t, const void *p, u32 sz, u32 alig
 			}
 			pushbuf.resize(pushbuf.size() + sz + pad);
 			if (pad) {
-				memset(pushbuf.data() + cmd.ptr - pad, 0, pad);
+				memset(pushbuf.data() + cmd.ptr - pushbufBase - pad, 0, pad);
 			}
-			memcpy(pushbuf.data() + cmd.ptr, p, sz);
+			memcpy(pushbuf.data() + cmd.ptr - pushbufBase, p, sz);
 		}
+		blobs[key] = cmd.ptr;
 	}
 
 	commands.push_back(cmd);
@@ -292,24 +423,8 @@ static void EmitTextureData(int level, u32 texaddr) {
 	}
 
 	if (bytes > 0) {
-		FlushRegisters();
-
-		// Dumps are huge - let's try to find this already emitted.
-		for (u32 prevptr : lastTextures) {
-			if (pushbuf.size() < prevptr + bytes) {
-				continue;
-			}
-
-			if (memcmp(pushbuf.data() + prevptr, p, bytes) == 0) {
-				commands.push_back({type, bytes, prevptr});
-				// Okay, that was easy.  Bail out.
-				return;
-			}
-		}
-
-		// Not there, gotta emit anew.
-		Command cmd = EmitCommandWithRAM(type, p, bytes, 16);
-		lastTextures.push_back(cmd.ptr);
+		// Dumps are huge, but this will reuse the data if it was already emitted.
+		EmitCommandWithRAM(type, p, bytes, 16);
 	}
 }
 
@@ -409,9 +524,10 @@ bool IsActivePending() {
 	return nextFrame || active;
 }
 
-bool Activate() {
-	if (!nextFrame) {
+bool Activate(int frames) {
+	if (!nextFrame && !active) {
 		nextFrame = true;
+		framesToRecord = std::max(frames, 1);
 		flipLastAction = gpuStats.numFlips;
 		return true;
 	}
@@ -423,20 +539,51 @@ void SetCallback(const std::function<void(const Path &)> callback) {
 }
 
 static void FinishRecording() {
-	// We're done - this was just to write the result out.
-	Path filename = WriteRecording();
-	commands.clear();
-	pushbuf.clear();
+	// We're done - write out what's left and wait for the writer.
+	FlushChunk();
+	EndWriteThread();
+	blobs.clear();
 
-	NOTICE_LOG(SYSTEM, "Recording finished");
+	NOTICE_LOG(SYSTEM, "Recording finished (%d frames)", framesRecorded);
 	active = false;
 	flipLastAction = gpuStats.numFlips;
 
 	if (writeCallback)
-		writeCallback(filename);
+		writeCallback(writeFilename);
 	writeCallback = nullptr;
 }
 
+// Called on a frame boundary, returns true if the recording is complete.
+static bool FinishFrame() {
+	framesRecorded++;
+	if (framesRecorded >= framesToRecord) {
+		FinishRecording();
+		return true;
+	}
+
+	// Let the writer get started on this frame while we record the next.
+	FlushChunk();
+	frameHasDraws = false;
+	return false;
+}
+
+static void StopRecordingRequest() {
+	// This happens on the thread stopping the core, while the GPU may still be recording.
+	if (active || nextFrame)
+		stopRequested = true;
+}
+
+// Called on the GPU thread, closes out the file with the frames we have.
+static void CheckStopRequest() {
+	if (!stopRequested.exchange(false))
+		return;
+	if (active) {
+		WARN_LOG(SYSTEM, "Recording stopped early after %d frames", framesRecorded);
+		FinishRecording();
+	}
+	nextFrame = false;
+}
+
 void NotifyCommand(u32 pc) {
 	if (!active) {
 		return;
@@ -496,9 +643,10 @@ void NotifyMemcpy(u32 dest, u32 src, u32 sz) {
 	}
 	if (Memory::IsVRAMAddress(dest)) {
 		FlushRegisters();
-		Command cmd{CommandType::MEMCPYDEST, sizeof(dest), (u32)pushbuf.size()};
+		Command cmd{CommandType::MEMCPYDEST, sizeof(dest), pushbufBase + (u32)pushbuf.size()};
 		pushbuf.resize(pushbuf.size() + sizeof(dest));
-		memcpy(pushbuf.data() + cmd.ptr, &dest, sizeof(dest));
+		memcpy(pushbuf.data() + cmd.ptr - pushbufBase, &dest, sizeof(dest));
+		commands.push_back(cmd);
 
 		sz = Memory::ValidSize(dest, sz);
 		if (sz != 0) {
@@ -522,9 +670,10 @@ void NotifyMemset(u32 dest, int v, u32 sz) {
 		MemsetCommand data{dest, v, sz};
 
 		FlushRegisters();
-		Command cmd{CommandType::MEMSET, sizeof(data), (u32)pushbuf.size()};
+		Command cmd{CommandType::MEMSET, sizeof(data), pushbufBase + (u32)pushbuf.size()};
 		pushbuf.resize(pushbuf.size() + sizeof(data));
-		memcpy(pushbuf.data() + cmd.ptr, &data, sizeof(data));
+		memcpy(pushbuf.data() + cmd.ptr - pushbufBase, &data, sizeof(data));
+		commands.push_back(cmd);
 	}
 }
 
@@ -536,8 +685,8 @@ void NotifyUpload(u32 dest, u32 sz) {
 }
 
 static bool HasDrawCommands() {
-	if (commands.empty())
-		return false;
+	if (frameHasDraws)
+		return true;
 
 	for (const Command &cmd : commands) {
 		switch (cmd.type) {
@@ -554,7 +703,18 @@ static bool HasDrawCommands() {
 	return false;
 }
 
+static void EmitDisplay(const void *data, u32 sz) {
+	FlushRegisters();
+	u32 ptr = (u32)pushbuf.size();
+	pushbuf.resize(pushbuf.size() + sz);
+	memcpy(pushbuf.data() + ptr, data, sz);
+
+	commands.push_back({ CommandType::DISPLAY, sz, pushbufBase + ptr });
+}
+
 void NotifyDisplay(u32 framebuf, int stride, int fmt) {
+	CheckStopRequest();
+
 	bool writePending = false;
 	if (active && HasDrawCommands()) {
 		writePending = true;
@@ -566,6 +726,8 @@ void NotifyDisplay(u32 framebuf, int stride, int fmt) {
 	if (!active) {
 		return;
 	}
+	// Frames are ended here as long as the game keeps setting the display.
+	flipLastAction = gpuStats.numFlips;
 
 	struct DisplayBufData {
 		PSPPointer<u8> topaddr;
@@ -573,27 +735,19 @@ void NotifyDisplay(u32 framebuf, int stride, int fmt) {
 	};
 
 	DisplayBufData disp{ { framebuf }, stride, fmt };
+	EmitDisplay(&disp, (u32)sizeof(disp));
 
-	FlushRegisters();
-	u32 ptr = (u32)pushbuf.size();
-	u32 sz = (u32)sizeof(disp);
-	pushbuf.resize(pushbuf.size() + sz);
-	memcpy(pushbuf.data() + ptr, &disp, sz);
-
-	commands.push_back({ CommandType::DISPLAY, sz, ptr });
-
-	if (writePending) {
+	if (writePending && FinishFrame()) {
 		NOTICE_LOG(SYSTEM, "Recording complete on display");
-		FinishRecording();
 	}
 }
 
 void NotifyFrame() {
+	CheckStopRequest();
+
 	const bool noDisplayAction = flipLastAction + 4 < gpuStats.numFlips;
-	// We do this only to catch things that don't call NotifyFrame.
+	// We do this only to catch things that don't call NotifyDisplay.
 	if (active && HasDrawCommands() && noDisplayAction) {
-		NOTICE_LOG(SYSTEM, "Recording complete on frame");
-
 		struct DisplayBufData {
 			PSPPointer<u8> topaddr;
 			u32 linesize, pixelFormat;
@@ -601,16 +755,11 @@ void NotifyFrame() {
 
 		DisplayBufData disp;
 		__DisplayGetFramebuf(&disp.topaddr, &disp.linesize, &disp.pixelFormat, 0);
+		EmitDisplay(&disp, (u32)sizeof(disp));
 
-		FlushRegisters();
-		u32 ptr = (u32)pushbuf.size();
-		u32 sz = (u32)sizeof(disp);
-		pushbuf.resize(pushbuf.size() + sz);
-		memcpy(pushbuf.data() + ptr, &disp, sz);
-
-		commands.push_back({ CommandType::DISPLAY, sz, ptr });
-
-		FinishRecording();
+		if (FinishFrame()) {
+			NOTICE_LOG(SYSTEM, "Recording complete on frame");
+		}
 	}
 	if (nextFrame && (gstate_c.skipDrawReason & SKIPDRAW_SKIPFRAME) == 0 && noDisplayAction) {
 		NOTICE_LOG(SYSTEM, "Recording starting on frame...");
@@ -618,4 +767,10 @@ void NotifyFrame() {
 	}
 }
 
+void Shutdown() {
+	// The GPU won't flip again, so finish any recording now.
+	stopRequested = true;
+	CheckStopRequest();
+}
+
 };
@@ -27,7 +27,8 @@ namespace GPURecord {
 
 bool IsActive();
 bool IsActivePending();
-bool Activate();
+// Records the next frames consecutive frames into one dump.
+bool Activate(int frames = 1);
 // Call only if Activate() returns true.
 void SetCallback(const std::function<void(const Path &)> callback);
 
@@ -37,5 +38,7 @@ void NotifyMemset(u32 dest, int v, u32 sz);
 void NotifyUpload(u32 dest, u32 sz);
 void NotifyDisplay(u32 addr, int stride, int fmt);
 void NotifyFrame();
+// Finishes a recording in progress, call when the GPU shuts down.
+void Shutdown();
 
 };
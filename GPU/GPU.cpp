@@ -23,6 +23,7 @@
 
 #include "GPU/GPU.h"
 #include "GPU/GPUInterface.h"
+#include "GPU/Debugger/Record.h"
 
 #if PPSSPP_API(ANY_GL)
 #include "GPU/GLES/GPU_GLES.h"
@@ -119,6 +120,7 @@ void GPU_Shutdown() {
 			sleep_ms(10);
 		}
 	}
+	GPURecord::Shutdown();
 	delete gpu;
 	gpu = nullptr;
 	gpuDebug = nullptr;
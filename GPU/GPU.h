@@ -63,6 +63,9 @@ struct GPUStatistics {
 		numCachedVertsDrawn = 0;
 		numUncachedVertsDrawn = 0;
 		numTrackedVertexArrays = 0;
+		numVertexCacheHits = 0;
+		numVertexCacheMisses = 0;
+		numVertexCacheRehashes = 0;
 		numTextureInvalidations = 0;
 		numTextureInvalidationsByFramebuffer = 0;
 		numTexturesHashed = 0;
@@ -89,6 +92,9 @@ struct GPUStatistics {
 	int numCachedVertsDrawn;
 	int numUncachedVertsDrawn;
 	int numTrackedVertexArrays;
+	int numVertexCacheHits;
+	int numVertexCacheMisses;
+	int numVertexCacheRehashes;
 	int numTextureInvalidations;
 	int numTextureInvalidationsByFramebuffer;
 	int numTexturesHashed;
@@ -1002,6 +1002,88 @@ inline Vec4f MATH3D_CALL Vec3ByMatrix44(const Vec3f v, const float m[16]) {
 #endif
 }
 
+// Four points at a time, in SoA form (x holds the x of all four, etc.)
+// These must round exactly like the single point versions above.
+#if defined(_M_SSE)
+#define MATH3D_HAS_X4 1
+typedef __m128 Vec4Lanes;
+
+inline void MATH3D_CALL Vec3ByMatrix43x4(__m128 out[3], __m128 x, __m128 y, __m128 z, const float m[12]) {
+	for (int i = 0; i < 3; ++i) {
+		out[i] = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[i]), x), _mm_mul_ps(_mm_set1_ps(m[3 + i]), y)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[6 + i]), z), _mm_set1_ps(m[9 + i])));
+	}
+}
+
+inline void MATH3D_CALL Vec3ByMatrix44x4(__m128 out[4], __m128 x, __m128 y, __m128 z, const float m[16]) {
+	for (int i = 0; i < 4; ++i) {
+		out[i] = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[i]), x), _mm_mul_ps(_mm_set1_ps(m[4 + i]), y)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[8 + i]), z), _mm_set1_ps(m[12 + i])));
+	}
+}
+
+// Loads four float[4]s and transposes them, or the reverse.
+inline void Load4x4Transposed(__m128 out[4], const float *p0, const float *p1, const float *p2, const float *p3) {
+	out[0] = _mm_loadu_ps(p0);
+	out[1] = _mm_loadu_ps(p1);
+	out[2] = _mm_loadu_ps(p2);
+	out[3] = _mm_loadu_ps(p3);
+	_MM_TRANSPOSE4_PS(out[0], out[1], out[2], out[3]);
+}
+
+inline void Store4x4Transposed(float *p0, float *p1, float *p2, float *p3, const __m128 in[4]) {
+	__m128 r0 = in[0], r1 = in[1], r2 = in[2], r3 = in[3];
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_storeu_ps(p0, r0);
+	_mm_storeu_ps(p1, r1);
+	_mm_storeu_ps(p2, r2);
+	_mm_storeu_ps(p3, r3);
+}
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+#define MATH3D_HAS_X4 1
+typedef float32x4_t Vec4Lanes;
+
+inline void Vec3ByMatrix43x4(float32x4_t out[3], float32x4_t x, float32x4_t y, float32x4_t z, const float m[12]) {
+	for (int i = 0; i < 3; ++i) {
+		out[i] = vaddq_f32(
+			vaddq_f32(vmulq_n_f32(x, m[i]), vmulq_n_f32(y, m[3 + i])),
+			vaddq_f32(vmulq_n_f32(z, m[6 + i]), vdupq_n_f32(m[9 + i])));
+	}
+}
+
+inline void Vec3ByMatrix44x4(float32x4_t out[4], float32x4_t x, float32x4_t y, float32x4_t z, const float m[16]) {
+	for (int i = 0; i < 4; ++i) {
+		out[i] = vaddq_f32(
+			vaddq_f32(vmulq_n_f32(x, m[i]), vmulq_n_f32(y, m[4 + i])),
+			vaddq_f32(vmulq_n_f32(z, m[8 + i]), vdupq_n_f32(m[12 + i])));
+	}
+}
+
+inline void Transpose4x4(float32x4_t out[4], float32x4_t r0, float32x4_t r1, float32x4_t r2, float32x4_t r3) {
+	float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	float32x4x2_t t23 = vtrnq_f32(r2, r3);
+	out[0] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	out[1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	out[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	out[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline void Load4x4Transposed(float32x4_t out[4], const float *p0, const float *p1, const float *p2, const float *p3) {
+	Transpose4x4(out, vld1q_f32(p0), vld1q_f32(p1), vld1q_f32(p2), vld1q_f32(p3));
+}
+
+inline void Store4x4Transposed(float *p0, float *p1, float *p2, float *p3, const float32x4_t in[4]) {
+	float32x4_t rows[4];
+	Transpose4x4(rows, in[0], in[1], in[2], in[3]);
+	vst1q_f32(p0, rows[0]);
+	vst1q_f32(p1, rows[1]);
+	vst1q_f32(p2, rows[2]);
+	vst1q_f32(p3, rows[3]);
+}
+#endif
+
 #if defined(_M_SSE)
 // x, y, and z should be broadcast.  Should only be used through Vec3f version.
 inline __m128 MATH3D_CALL Norm3ByMatrix43Internal(__m128 x, __m128 y, __m128 z, const float m[12]) {
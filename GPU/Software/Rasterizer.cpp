@@ -142,6 +142,7 @@ void ComputeRasterizerState(RasterizerState *state) {
 	state->shadeGouraud = gstate.getShadeMode() == GE_SHADE_GOURAUD;
 	state->throughMode = gstate.isModeThrough();
 	state->antialiasLines = gstate.isAntiAliasEnabled();
+	state->hierarchicalRaster = g_Config.bSoftwareRenderingHierarchical;
 
 	state->screenOffsetX = gstate.getOffsetX16();
 	state->screenOffsetY = gstate.getOffsetY16();
@@ -522,6 +523,15 @@ static inline void ApplyTexturing(const RasterizerState &state, Vec4<int> *prim_
 	}
 }
 
+// Size of the tiles (in 2x2 pixel quads) classified before testing individual quads.
+static constexpr int TILE_QUADS = 4;
+
+enum class TileCoverage {
+	OUTSIDE,
+	PARTIAL,
+	INSIDE,
+};
+
 template <bool useSSE4>
 struct TriangleEdge {
 	Vec4<int> Start(const ScreenCoords &v0, const ScreenCoords &v1, const ScreenCoords &origin);
@@ -530,6 +540,8 @@ struct TriangleEdge {
 
 	inline void NarrowMinMaxX(const Vec4<int> &w, int64_t minX, int64_t &rowMinX, int64_t &rowMaxX);
 	inline Vec4<int> StepXTimes(const Vec4<int> &w, int c);
+	inline Vec4<int> StepYTimes(const Vec4<int> &w, int c);
+	inline TileCoverage ClassifyTile(const Vec4<int> &w, int bias);
 
 	Vec4<int> stepX;
 	Vec4<int> stepY;
@@ -641,6 +653,54 @@ inline Vec4<int> TriangleEdge<useSSE4>::StepXTimes(const Vec4<int> &w, int c) {
 	return w + stepX * c;
 }
 
+template <bool useSSE4>
+inline Vec4<int> TriangleEdge<useSSE4>::StepYTimes(const Vec4<int> &w, int c) {
+#if defined(_M_SSE) && !PPSSPP_ARCH(X86)
+	if (useSSE4)
+		return StepTimesSSE4(w.ivec, stepY.ivec, c);
+#endif
+	return w + stepY * c;
+}
+
+template <bool useSSE4>
+inline TileCoverage TriangleEdge<useSSE4>::ClassifyTile(const Vec4<int> &w, int bias) {
+	// The edge is linear, so the extremes are at the corner pixels.  Steps are per quad, so half is a pixel.
+	const int64_t pixels = TILE_QUADS * 2 - 1;
+	const int64_t dx = (int64_t)(stepX.x / 2) * pixels;
+	const int64_t dy = (int64_t)(stepY.x / 2) * pixels;
+	const int64_t start = (int64_t)w.x + bias;
+
+	if (start + std::min(dx, (int64_t)0) + std::min(dy, (int64_t)0) >= 0)
+		return TileCoverage::INSIDE;
+	if (start + std::max(dx, (int64_t)0) + std::max(dy, (int64_t)0) < 0)
+		return TileCoverage::OUTSIDE;
+	return TileCoverage::PARTIAL;
+}
+
+// ClassifyTile() works from the edge value at a tile's first pixel, so it needs the 32-bit
+// values the quad walk computes to be exact (not wrapped) anywhere a tile might reach.
+static bool TileEdgesFitInt32(const ScreenCoords &v0, const ScreenCoords &v1, const ScreenCoords &v2, int64_t minX, int64_t minY, int64_t maxX, int64_t maxY) {
+	const int64_t xs[2] = { minX + 7, maxX + 32 * TILE_QUADS + 7 };
+	const int64_t ys[2] = { minY + 7, maxY + 32 * TILE_QUADS + 7 };
+	const ScreenCoords *verts[3] = { &v0, &v1, &v2 };
+	for (int i = 0; i < 3; ++i) {
+		const ScreenCoords &a = *verts[(i + 1) % 3];
+		const ScreenCoords &b = *verts[(i + 2) % 3];
+		const int64_t xf = a.y - b.y;
+		const int64_t yf = b.x - a.x;
+		const int64_t c = (int64_t)b.y * a.x - (int64_t)b.x * a.y;
+		for (int64_t x : xs) {
+			for (int64_t y : ys) {
+				int64_t w = xf * x + yf * y + c;
+				// Leave room for the bias, too.
+				if (w <= INT32_MIN || w > INT32_MAX)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
 static inline Vec4<int> MakeMask(const Vec4<int> &w0, const Vec4<int> &w1, const Vec4<int> &w2, const Vec4<int> &bias0, const Vec4<int> &bias1, const Vec4<int> &bias2, const Vec4<int> &scissor) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	__m128i biased0 = _mm_add_epi32(w0.ivec, bias0.ivec);
@@ -727,137 +787,196 @@ void DrawTriangleSlice(
 	std::string ztag = StringFromFormat("DisplayListTZ_%08x", state.listPC);
 #endif
 
-	for (int64_t curY = minY; curY <= maxY; curY += 32,
-										w0_base = e0.StepY(w0_base),
-										w1_base = e1.StepY(w1_base),
-										w2_base = e2.StepY(w2_base)) {
-		Vec4<int> w0 = w0_base;
-		Vec4<int> w1 = w1_base;
-		Vec4<int> w2 = w2_base;
-
-		DrawingCoords p = TransformUnit::ScreenToDrawing(minX, curY, state.screenOffsetX, state.screenOffsetY);
-
-		int64_t rowMinX = minX, rowMaxX = maxX;
-		e0.NarrowMinMaxX(w0, minX, rowMinX, rowMaxX);
-		e1.NarrowMinMaxX(w1, minX, rowMinX, rowMaxX);
-		e2.NarrowMinMaxX(w2, minX, rowMinX, rowMaxX);
-
-		int skipX = (rowMinX - minX) / 32;
-		w0 = e0.StepXTimes(w0, skipX);
-		w1 = e1.StepXTimes(w1, skipX);
-		w2 = e2.StepXTimes(w2, skipX);
-		p.x = (p.x + 2 * skipX) & 0x3FF;
-
-		// TODO: Maybe we can clip the edges instead?
-		int scissorYPlus1 = curY + 16 > maxY ? -1 : 0;
-		Vec4<int> scissor_mask = Vec4<int>(0, rowMaxX - rowMinX - 16, scissorYPlus1, (rowMaxX - rowMinX - 16) | scissorYPlus1);
-		Vec4<int> scissor_step = Vec4<int>(0, -32, 0, -32);
-
-		for (int64_t curX = rowMinX; curX <= rowMaxX; curX += 32,
-			w0 = e0.StepX(w0),
-			w1 = e1.StepX(w1),
-			w2 = e2.StepX(w2),
-			scissor_mask = scissor_mask + scissor_step,
-			p.x = (p.x + 2) & 0x3FF) {
-
-			// If p is on or inside all edges, render pixel
-			Vec4<int> mask = MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
-			if (AnyMask<useSSE4>(mask)) {
-				Vec4<float> wsum_recip = EdgeRecip(w0, w1, w2);
-
-				Vec4<int> prim_color[4];
-				if (!flatColor0) {
-					// Does the PSP do perspective-correct color interpolation? The GC doesn't.
-					for (int i = 0; i < 4; ++i) {
-						if (mask[i] >= 0)
-							prim_color[i] = Interpolate(v0.color0, v1.color0, v2.color0, w0[i], w1[i], w2[i], wsum_recip[i]);
-					}
-				} else {
-					for (int i = 0; i < 4; ++i) {
-						prim_color[i] = v2.color0;
-					}
-				}
-				Vec3<int> sec_color[4];
-				if (!flatColor1) {
-					for (int i = 0; i < 4; ++i) {
-						if (mask[i] >= 0)
-							sec_color[i] = Interpolate(v0.color1, v1.color1, v2.color1, w0[i], w1[i], w2[i], wsum_recip[i]);
-					}
-				} else {
-					for (int i = 0; i < 4; ++i) {
-						sec_color[i] = v2.color1;
-					}
-				}
+	auto shadeQuad = [&](const Vec4<int> &w0, const Vec4<int> &w1, const Vec4<int> &w2, const Vec4<int> &mask, int64_t curX, int64_t curY, const DrawingCoords &p) {
+		Vec4<float> wsum_recip = EdgeRecip(w0, w1, w2);
 
-				if (state.enableTextures && !clearMode) {
-					Vec4<float> s, t;
-					if (state.throughMode) {
-						s = Interpolate(v0.texturecoords.s(), v1.texturecoords.s(), v2.texturecoords.s(), w0, w1, w2, wsum_recip);
-						t = Interpolate(v0.texturecoords.t(), v1.texturecoords.t(), v2.texturecoords.t(), w0, w1, w2, wsum_recip);
-
-						// For levels > 0, mipmapping is always based on level 0.  Simpler to scale first.
-						s *= 1.0f / (float)(1 << state.samplerID.width0Shift);
-						t *= 1.0f / (float)(1 << state.samplerID.height0Shift);
-					} else {
-						// Texture coordinate interpolation must definitely be perspective-correct.
-						GetTextureCoordinates(v0, v1, v2, w0, w1, w2, wsum_recip, s, t);
-					}
+		Vec4<int> prim_color[4];
+		if (!flatColor0) {
+			// Does the PSP do perspective-correct color interpolation? The GC doesn't.
+			for (int i = 0; i < 4; ++i) {
+				if (mask[i] >= 0)
+					prim_color[i] = Interpolate(v0.color0, v1.color0, v2.color0, w0[i], w1[i], w2[i], wsum_recip[i]);
+			}
+		} else {
+			for (int i = 0; i < 4; ++i) {
+				prim_color[i] = v2.color0;
+			}
+		}
+		Vec3<int> sec_color[4];
+		if (!flatColor1) {
+			for (int i = 0; i < 4; ++i) {
+				if (mask[i] >= 0)
+					sec_color[i] = Interpolate(v0.color1, v1.color1, v2.color1, w0[i], w1[i], w2[i], wsum_recip[i]);
+			}
+		} else {
+			for (int i = 0; i < 4; ++i) {
+				sec_color[i] = v2.color1;
+			}
+		}
 
-					ApplyTexturing(state, prim_color, mask, s, t, curX, curY);
-				}
+		if (state.enableTextures && !clearMode) {
+			Vec4<float> s, t;
+			if (state.throughMode) {
+				s = Interpolate(v0.texturecoords.s(), v1.texturecoords.s(), v2.texturecoords.s(), w0, w1, w2, wsum_recip);
+				t = Interpolate(v0.texturecoords.t(), v1.texturecoords.t(), v2.texturecoords.t(), w0, w1, w2, wsum_recip);
+
+				// For levels > 0, mipmapping is always based on level 0.  Simpler to scale first.
+				s *= 1.0f / (float)(1 << state.samplerID.width0Shift);
+				t *= 1.0f / (float)(1 << state.samplerID.height0Shift);
+			} else {
+				// Texture coordinate interpolation must definitely be perspective-correct.
+				GetTextureCoordinates(v0, v1, v2, w0, w1, w2, wsum_recip, s, t);
+			}
+
+			ApplyTexturing(state, prim_color, mask, s, t, curX, curY);
+		}
 
-				if (!clearMode) {
-					for (int i = 0; i < 4; ++i) {
+		if (!clearMode) {
+			for (int i = 0; i < 4; ++i) {
 #if defined(_M_SSE)
-						// TODO: Tried making Vec4 do this, but things got slower.
-						const __m128i sec = _mm_and_si128(sec_color[i].ivec, _mm_set_epi32(0, -1, -1, -1));
-						prim_color[i].ivec = _mm_add_epi32(prim_color[i].ivec, sec);
+				// TODO: Tried making Vec4 do this, but things got slower.
+				const __m128i sec = _mm_and_si128(sec_color[i].ivec, _mm_set_epi32(0, -1, -1, -1));
+				prim_color[i].ivec = _mm_add_epi32(prim_color[i].ivec, sec);
 #else
-						prim_color[i] += Vec4<int>(sec_color[i], 0);
+				prim_color[i] += Vec4<int>(sec_color[i], 0);
 #endif
-					}
-				}
+			}
+		}
 
-				Vec4<int> fog = Vec4<int>::AssignToAll(255);
-				if (!noFog) {
-					Vec4<float> fogdepths = w0.Cast<float>() * v0.fogdepth + w1.Cast<float>() * v1.fogdepth + w2.Cast<float>() * v2.fogdepth;
-					fogdepths = fogdepths * wsum_recip;
-					for (int i = 0; i < 4; ++i) {
-						fog[i] = ClampFogDepth(fogdepths[i]);
-					}
-				}
+		Vec4<int> fog = Vec4<int>::AssignToAll(255);
+		if (!noFog) {
+			Vec4<float> fogdepths = w0.Cast<float>() * v0.fogdepth + w1.Cast<float>() * v1.fogdepth + w2.Cast<float>() * v2.fogdepth;
+			fogdepths = fogdepths * wsum_recip;
+			for (int i = 0; i < 4; ++i) {
+				fog[i] = ClampFogDepth(fogdepths[i]);
+			}
+		}
 
-				Vec4<int> z;
-				if (flatZ) {
-					z = Vec4<int>::AssignToAll(v2.screenpos.z);
-				} else {
-					// TODO: Is that the correct way to interpolate?
-					Vec4<float> zfloats = w0.Cast<float>() * v0.screenpos.z + w1.Cast<float>() * v1.screenpos.z + w2.Cast<float>() * v2.screenpos.z;
-					z = (zfloats * wsum_recip).Cast<int>();
-				}
+		Vec4<int> z;
+		if (flatZ) {
+			z = Vec4<int>::AssignToAll(v2.screenpos.z);
+		} else {
+			// TODO: Is that the correct way to interpolate?
+			Vec4<float> zfloats = w0.Cast<float>() * v0.screenpos.z + w1.Cast<float>() * v1.screenpos.z + w2.Cast<float>() * v2.screenpos.z;
+			z = (zfloats * wsum_recip).Cast<int>();
+		}
 
-				PROFILE_THIS_SCOPE("draw_tri_px");
-				DrawingCoords subp = p;
-				for (int i = 0; i < 4; ++i) {
-					if (mask[i] < 0) {
-						continue;
-					}
-					subp.x = p.x + (i & 1);
-					subp.y = p.y + (i / 2);
+		PROFILE_THIS_SCOPE("draw_tri_px");
+		DrawingCoords subp = p;
+		for (int i = 0; i < 4; ++i) {
+			if (mask[i] < 0) {
+				continue;
+			}
+			subp.x = p.x + (i & 1);
+			subp.y = p.y + (i / 2);
 
-					state.drawPixel(subp.x, subp.y, z[i], fog[i], ToVec4IntArg(prim_color[i]), pixelID);
+			state.drawPixel(subp.x, subp.y, z[i], fog[i], ToVec4IntArg(prim_color[i]), pixelID);
 
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
-					uint32_t row = gstate.getFrameBufAddress() + subp.y * pixelID.cached.framebufStride * bpp;
-					NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * bpp, bpp, tag.c_str(), tag.size());
-					if (pixelID.depthWrite) {
-						row = gstate.getDepthBufAddress() + subp.y * pixelID.cached.depthbufStride * 2;
-						NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * 2, 2, ztag.c_str(), ztag.size());
-					}
+			uint32_t row = gstate.getFrameBufAddress() + subp.y * pixelID.cached.framebufStride * bpp;
+			NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * bpp, bpp, tag.c_str(), tag.size());
+			if (pixelID.depthWrite) {
+				row = gstate.getDepthBufAddress() + subp.y * pixelID.cached.depthbufStride * 2;
+				NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * 2, 2, ztag.c_str(), ztag.size());
+			}
 #endif
+		}
+	};
+
+	if (state.hierarchicalRaster && TileEdgesFitInt32(v0.screenpos, v1.screenpos, v2.screenpos, minX, minY, maxX, maxY)) {
+		// Walk TILE_QUADS x TILE_QUADS quad tiles, and only test edges per quad when a tile straddles one.
+		// Quads are visited in a different order, but each pixel gets exactly the same weights and mask.
+		for (int64_t tileY = minY; tileY <= maxY; tileY += 32 * TILE_QUADS,
+											w0_base = e0.StepYTimes(w0_base, TILE_QUADS),
+											w1_base = e1.StepYTimes(w1_base, TILE_QUADS),
+											w2_base = e2.StepYTimes(w2_base, TILE_QUADS)) {
+			Vec4<int> tw0 = w0_base;
+			Vec4<int> tw1 = w1_base;
+			Vec4<int> tw2 = w2_base;
+
+			for (int64_t tileX = minX; tileX <= maxX; tileX += 32 * TILE_QUADS,
+												tw0 = e0.StepXTimes(tw0, TILE_QUADS),
+												tw1 = e1.StepXTimes(tw1, TILE_QUADS),
+												tw2 = e2.StepXTimes(tw2, TILE_QUADS)) {
+				TileCoverage c0 = e0.ClassifyTile(tw0, bias0.x);
+				TileCoverage c1 = e1.ClassifyTile(tw1, bias1.x);
+				TileCoverage c2 = e2.ClassifyTile(tw2, bias2.x);
+				if (c0 == TileCoverage::OUTSIDE || c1 == TileCoverage::OUTSIDE || c2 == TileCoverage::OUTSIDE)
+					continue;
+				const bool inside = c0 == TileCoverage::INSIDE && c1 == TileCoverage::INSIDE && c2 == TileCoverage::INSIDE;
+
+				Vec4<int> rw0 = tw0;
+				Vec4<int> rw1 = tw1;
+				Vec4<int> rw2 = tw2;
+				for (int64_t curY = tileY; curY <= maxY && curY < tileY + 32 * TILE_QUADS; curY += 32,
+												rw0 = e0.StepY(rw0),
+												rw1 = e1.StepY(rw1),
+												rw2 = e2.StepY(rw2)) {
+					Vec4<int> w0 = rw0;
+					Vec4<int> w1 = rw1;
+					Vec4<int> w2 = rw2;
+
+					// Match the row walk below exactly, including x wrapping.
+					DrawingCoords p = TransformUnit::ScreenToDrawing(minX, curY, state.screenOffsetX, state.screenOffsetY);
+					p.x = (p.x + 2 * (int)((tileX - minX) / 32)) & 0x3FF;
+
+					int scissorYPlus1 = curY + 16 > maxY ? -1 : 0;
+					for (int64_t curX = tileX; curX <= maxX && curX < tileX + 32 * TILE_QUADS; curX += 32,
+						w0 = e0.StepX(w0),
+						w1 = e1.StepX(w1),
+						w2 = e2.StepX(w2),
+						p.x = (p.x + 2) & 0x3FF) {
+						int scissorX = (int)(maxX - curX - 16);
+						Vec4<int> scissor_mask = Vec4<int>(0, scissorX, scissorYPlus1, scissorX | scissorYPlus1);
+
+						// Trivially accepted tiles only need the scissor.
+						Vec4<int> mask = inside ? scissor_mask : MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
+						if (AnyMask<useSSE4>(mask))
+							shadeQuad(w0, w1, w2, mask, curX, curY, p);
+					}
 				}
 			}
 		}
+	} else {
+		for (int64_t curY = minY; curY <= maxY; curY += 32,
+											w0_base = e0.StepY(w0_base),
+											w1_base = e1.StepY(w1_base),
+											w2_base = e2.StepY(w2_base)) {
+			Vec4<int> w0 = w0_base;
+			Vec4<int> w1 = w1_base;
+			Vec4<int> w2 = w2_base;
+
+			DrawingCoords p = TransformUnit::ScreenToDrawing(minX, curY, state.screenOffsetX, state.screenOffsetY);
+
+			int64_t rowMinX = minX, rowMaxX = maxX;
+			e0.NarrowMinMaxX(w0, minX, rowMinX, rowMaxX);
+			e1.NarrowMinMaxX(w1, minX, rowMinX, rowMaxX);
+			e2.NarrowMinMaxX(w2, minX, rowMinX, rowMaxX);
+
+			int skipX = (rowMinX - minX) / 32;
+			w0 = e0.StepXTimes(w0, skipX);
+			w1 = e1.StepXTimes(w1, skipX);
+			w2 = e2.StepXTimes(w2, skipX);
+			p.x = (p.x + 2 * skipX) & 0x3FF;
+
+			// TODO: Maybe we can clip the edges instead?
+			int scissorYPlus1 = curY + 16 > maxY ? -1 : 0;
+			Vec4<int> scissor_mask = Vec4<int>(0, rowMaxX - rowMinX - 16, scissorYPlus1, (rowMaxX - rowMinX - 16) | scissorYPlus1);
+			Vec4<int> scissor_step = Vec4<int>(0, -32, 0, -32);
+
+			for (int64_t curX = rowMinX; curX <= rowMaxX; curX += 32,
+				w0 = e0.StepX(w0),
+				w1 = e1.StepX(w1),
+				w2 = e2.StepX(w2),
+				scissor_mask = scissor_mask + scissor_step,
+				p.x = (p.x + 2) & 0x3FF) {
+
+				// If p is on or inside all edges, render pixel
+				Vec4<int> mask = MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
+				if (AnyMask<useSSE4>(mask))
+					shadeQuad(w0, w1, w2, mask, curX, curY, p);
+			}
+		}
 	}
 
 #if !defined(SOFTGPU_MEMORY_TAGGING_DETAILED) && defined(SOFTGPU_MEMORY_TAGGING_BASIC)
@@ -56,6 +56,7 @@ struct RasterizerState {
 		bool minFilt : 1;
 		bool magFilt : 1;
 		bool antialiasLines : 1;
+		bool hierarchicalRaster : 1;
 	};
 
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED) || defined(SOFTGPU_MEMORY_TAGGING_BASIC)
@@ -779,6 +779,8 @@ void SoftGPU::Execute_Prim(u32 op, u32 diff) {
 	}
 
 	cyclesExecuted += EstimatePerVertexCost() * count;
+	gpuStats.numDrawCalls++;
+	gpuStats.numVertsSubmitted += count;
 	int bytesRead;
 	UpdateUVScaleOffset();
 	drawEngine_->transformUnit.SetDirty(dirtyFlags_);
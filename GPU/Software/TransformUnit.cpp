@@ -23,6 +23,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -165,6 +166,12 @@ ScreenCoords TransformUnit::DrawingToScreen(const DrawingCoords &coords, u16 z)
 	return ret;
 }
 
+enum {
+	// Below this, it's cheaper to just transform as we go.
+	PRETRANSFORM_MIN_VERTS = 1024,
+	PRETRANSFORM_CHUNK_VERTS = 256,
+};
+
 enum class MatrixMode {
 	NONE = 0,
 	POS_TO_CLIP = 1,
@@ -437,6 +444,25 @@ VertexData TransformUnit::ReadVertex(VertexReader &vreader, const TransformState
 	return vertex;
 }
 
+void TransformUnit::PretransformVertices(const DecVtxFormat &vtxfmt, u32 vertex_type, int count, const TransformState &state) {
+	PROFILE_THIS_SCOPE("pretransform");
+	if ((int)pretransformed_.size() < count) {
+		pretransformed_.resize(count);
+		pretransformedOutside_.resize(count);
+	}
+
+	// ReadVertex only reads gstate and the decoded vertices, so this is safe to split up.
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		VertexReader vreader(decoded_, vtxfmt, vertex_type);
+		for (int i = lower; i < upper; ++i) {
+			bool outside = false;
+			vreader.Goto(i);
+			pretransformed_[i] = ReadVertex(vreader, state, outside);
+			pretransformedOutside_[i] = outside ? 1 : 0;
+		}
+	}, 0, count, PRETRANSFORM_CHUNK_VERTS);
+}
+
 void TransformUnit::SetDirty(SoftDirty flags) {
 	binner_->SetDirty(flags);
 }
@@ -500,8 +526,8 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 	default: vtcs_per_prim = 0; break;
 	}
 
-	// TODO: Do this in two passes - first process the vertices (before indexing/stripping),
-	// then resolve the indices. This lets us avoid transforming shared vertices twice.
+	// TODO: Draws below PRETRANSFORM_MIN_VERTS (or without transform / worker threads) still read
+	// each vertex as it's indexed, so shared vertices get transformed more than once.
 
 	binner_->UpdateState();
 
@@ -514,20 +540,31 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 	bool skipCull = !gstate.isCullEnabled() || gstate.isModeClear();
 	const CullType cullType = skipCull ? CullType::OFF : (gstate.getCullMode() ? CullType::CCW : CullType::CW);
 
+	// Large draws transform all their vertices up front on the worker threads, while prims are still
+	// assembled, clipped, and binned in order here.  This also skips transforming shared vertices twice.
+	const bool pretransform = vertex_count >= PRETRANSFORM_MIN_VERTS && transformState.enableTransform && g_threadManager.GetNumLooperThreads() > 1;
+	if (pretransform)
+		PretransformVertices(vtxfmt, vertex_type, index_upper_bound - index_lower_bound + 1, transformState);
+
 	bool outside_range_flag = false;
+	auto readVertex = [&](int vtx) {
+		const int index = indices ? ConvertIndex(vtx) - index_lower_bound : vtx;
+		if (pretransform) {
+			if (pretransformedOutside_[index])
+				outside_range_flag = true;
+			return pretransformed_[index];
+		}
+		vreader.Goto(index);
+		return ReadVertex(vreader, transformState, outside_range_flag);
+	};
+
 	switch (prim_type) {
 	case GE_PRIM_POINTS:
 	case GE_PRIM_LINES:
 	case GE_PRIM_TRIANGLES:
 		{
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[data_index++] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[data_index++] = readVertex(vtx);
 				if (data_index < vtcs_per_prim) {
 					// Keep reading.  Note: an incomplete prim will stay read for GE_PRIM_KEEP_PREVIOUS.
 					continue;
@@ -572,13 +609,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 	case GE_PRIM_RECTANGLES:
 		for (int vtx = 0; vtx < vertex_count; ++vtx) {
-			if (indices) {
-				vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-			} else {
-				vreader.Goto(vtx);
-			}
-
-			data[data_index++] = ReadVertex(vreader, transformState, outside_range_flag);
+			data[data_index++] = readVertex(vtx);
 			if (outside_range_flag) {
 				outside_range_flag = false;
 				// Note: this is the post increment index.  If odd, we set the first vert.
@@ -618,13 +649,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 			// If data_index is 1 or 2, etc., it means we're continuing a line strip.
 			int skip_count = data_index == 0 ? 1 : 0;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[(data_index++) & 1] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[(data_index++) & 1] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -651,13 +676,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 			// This is for Darkstalkers (and should speed up many 2D games).
 			if (data_index == 0 && vertex_count == 4 && gstate.isModeThrough() && cullType == CullType::OFF) {
 				for (int vtx = 0; vtx < 4; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					}
-					else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, transformState, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				// If a strip is effectively a rectangle, draw it as such!
@@ -669,14 +688,8 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			outside_range_flag = false;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = (data_index++) % 3;
-				data[provoking_index] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -712,12 +725,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			// Only read the central vertex if we're not continuing.
 			if (data_index == 0) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(0) - index_lower_bound);
-				} else {
-					vreader.Goto(0);
-				}
-				data[0] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[0] = readVertex(0);
 				data_index++;
 				start_vtx = 1;
 
@@ -728,12 +736,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			if (data_index == 1 && vertex_count == 4 && gstate.isModeThrough() && cullType == CullType::OFF) {
 				for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					} else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, transformState, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				int tl = -1, br = -1;
@@ -745,14 +748,8 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			outside_range_flag = false;
 			for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = 2 - ((data_index++) % 2);
-				data[provoking_index] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
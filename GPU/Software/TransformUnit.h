@@ -131,9 +131,14 @@ class TransformUnit {
 
 private:
 	VertexData ReadVertex(VertexReader &vreader, const TransformState &lstate, bool &outside_range_flag);
+	void PretransformVertices(const DecVtxFormat &vtxfmt, u32 vertex_type, int count, const TransformState &state);
 
 	u8 *decoded_ = nullptr;
 	BinManager *binner_ = nullptr;
+
+	// Used for large draws, indexed the same as decoded_.
+	std::vector<VertexData> pretransformed_;
+	std::vector<u8> pretransformedOutside_;
 };
 
 class SoftwareDrawEngine : public DrawEngineCommon {
@@ -43,6 +43,7 @@
 #include "Common/UI/View.h"
 #include "Common/UI/ViewGroup.h"
 #include "Common/UI/UI.h"
+#include "Common/File/FileUtil.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/LogManager.h"
@@ -66,6 +67,7 @@
 #include "UI/MainScreen.h"
 #include "UI/ControlMappingScreen.h"
 #include "UI/GameSettingsScreen.h"
+#include "UI/OnScreenDisplay.h"
 
 
 #ifdef _WIN32
@@ -112,6 +114,7 @@ void DevMenu::CreatePopupContents(UI::ViewGroup *parent) {
 	items->Add(new CheckBox(&g_Config.bShowFrameProfiler, dev->T("Frame Profiler"), ""));
 #endif
 	items->Add(new CheckBox(&g_Config.bDrawFrameGraph, dev->T("Draw Frametimes Graph")));
+	items->Add(new Choice(Profiler_IsTracing() ? dev->T("Stop Profile Trace") : dev->T("Start Profile Trace")))->OnClick.Handle(this, &DevMenu::OnToggleProfileTrace);
 	items->Add(new Choice(dev->T("Reset limited logging")))->OnClick.Handle(this, &DevMenu::OnResetLimitedLogging);
 
 	scroll->Add(items);
@@ -133,6 +136,23 @@ UI::EventReturn DevMenu::OnResetLimitedLogging(UI::EventParams &e) {
 	return UI::EVENT_DONE;
 }
 
+UI::EventReturn DevMenu::OnToggleProfileTrace(UI::EventParams &e) {
+	auto dev = GetI18NCategory("Developer");
+	if (!Profiler_IsTracing()) {
+		Profiler_SetTracing(true);
+		osm.Show(dev->T("Profile trace started"), 1.0f);
+	} else {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_DUMP));
+		Path filename = GetSysDirectory(DIRECTORY_DUMP) / "trace.json";
+		if (Profiler_SaveTrace(filename))
+			osm.Show(filename.ToVisualString(), 2.0f);
+		else
+			osm.Show(dev->T("Failed to save profile trace"), 2.0f);
+	}
+	TriggerFinish(DR_OK);
+	return UI::EVENT_DONE;
+}
+
 UI::EventReturn DevMenu::OnLogView(UI::EventParams &e) {
 	UpdateUIState(UISTATE_PAUSEMENU);
 	screenManager()->push(new LogScreen());
@@ -45,6 +45,7 @@ class DevMenu : public PopupScreen {
 	UI::EventReturn OnDeveloperTools(UI::EventParams &e);
 	UI::EventReturn OnToggleAudioDebug(UI::EventParams &e);
 	UI::EventReturn OnResetLimitedLogging(UI::EventParams &e);
+	UI::EventReturn OnToggleProfileTrace(UI::EventParams &e);
 };
 
 class JitDebugScreen : public UIDialogScreenWithBackground {
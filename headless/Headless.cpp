@@ -3,6 +3,8 @@
 // To build on non-windows systems, just run CMake in the SDL directory, it will build both a normal ppsspp and the headless version.
 
 #include "ppsspp_config.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
@@ -21,6 +23,8 @@
 #include "Common/CPUDetect.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/AssetReader.h"
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/File/DirListing.h"
 #include "Common/File/FileUtil.h"
 #include "Common/GraphicsContext.h"
 #include "Common/TimeUtil.h"
@@ -29,12 +33,15 @@
 #include "Core/ConfigValues.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/FileLoaders/DiskCachingFileLoader.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HLE/sceUtility.h"
 #include "Core/Host.h"
 #include "Core/SaveState.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Debugger/Playback.h"
 #include "Log.h"
 #include "LogManager.h"
 
@@ -127,6 +134,7 @@ int printUsage(const char *progname, const char *reason)
 		fprintf(stderr, "  --graphics=BACKEND    use the full gpu backend (slower)\n");
 		fprintf(stderr, "                        options: gles, software, directx9, etc.\n");
 		fprintf(stderr, "  --screenshot=FILE     compare against a screenshot\n");
+		fprintf(stderr, "  --flat-raster         software: skip hierarchical triangle tiles (to compare output)\n");
 	}
 #endif
 	fprintf(stderr, "  --timeout=SECONDS     abort test it if takes longer than SECONDS\n");
@@ -136,6 +144,14 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  --ir                  use ir interpreter\n");
 	fprintf(stderr, "  -j                    use jit (default)\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
+	fprintf(stderr, "  --syscall-stats       print time spent per HLE function after each test\n");
+	fprintf(stderr, "  --syscall-trace=FILE  write a binary trace of recent HLE calls after each test\n");
+	fprintf(stderr, "  --profile-trace=FILE  write a Chrome trace (JSON) of profiled scopes for all tests\n");
+	fprintf(stderr, "  --bench=N             replay each GE dump (or directory of dumps) N times and report frame times\n");
+	fprintf(stderr, "  --bench-output=FILE   write --bench results as JSON\n");
+	fprintf(stderr, "  --shared-disk-cache   cache http:// images on disk, shared with other instances\n");
+	fprintf(stderr, "                        (only one instance fills the cache, others read the backend\n");
+	fprintf(stderr, "                        on a miss, so instances started together save little)\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
 
 	return 1;
@@ -155,7 +171,89 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 	}
 }
 
-bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout)
+static void PrintSyscallStats() {
+	std::vector<HLESyscallStats> stats;
+	hleGetSyscallStats(stats);
+	std::sort(stats.begin(), stats.end(), [](const HLESyscallStats &a, const HLESyscallStats &b) {
+		return a.totalTime > b.totalTime;
+	});
+
+	fprintf(stderr, "%-40s %10s %12s %10s %10s\n", "Function", "Calls", "Total ms", "Avg us", "Max us");
+	for (size_t i = 0; i < stats.size() && i < 30; ++i) {
+		const HLESyscallStats &st = stats[i];
+		fprintf(stderr, "%-40s %10llu %12.3f %10.2f %10.2f\n", st.name, (unsigned long long)st.calls, st.totalTime * 1000.0, st.totalTime * 1000000.0 / st.calls, st.maxTime * 1000000.0);
+	}
+}
+
+static std::vector<std::string> ExpandBenchmarkDumps(const std::vector<std::string> &filenames) {
+	std::vector<std::string> expanded;
+	for (const std::string &filename : filenames) {
+		Path path(filename);
+		if (!File::IsDirectory(path)) {
+			expanded.push_back(filename);
+			continue;
+		}
+
+		std::vector<File::FileInfo> files;
+		File::GetFilesInDir(path, &files, "ppdmp:");
+		std::sort(files.begin(), files.end());
+		for (const File::FileInfo &file : files) {
+			if (!file.isDirectory)
+				expanded.push_back(file.fullName.ToString());
+		}
+	}
+	return expanded;
+}
+
+static void ReportBenchmark(json::JsonWriter &writer, const std::string &filename, int iterations) {
+	std::string backendStats;
+	std::vector<GPURecord::ReplayFrameStats> frames = GPURecord::TakeReplayBenchmark(&backendStats);
+	if (frames.empty()) {
+		fprintf(stderr, "%s: no frames replayed, not a GE dump?\n", filename.c_str());
+		return;
+	}
+
+	std::vector<double> times;
+	double total = 0.0;
+	int64_t totalDraws = 0;
+	int64_t totalVerts = 0;
+	for (const auto &frame : frames) {
+		times.push_back(frame.seconds * 1000.0);
+		total += frame.seconds * 1000.0;
+		totalDraws += frame.drawCalls;
+		totalVerts += frame.vertices;
+	}
+	std::sort(times.begin(), times.end());
+	// Nearest rank percentiles.
+	auto percentile = [&](double p) {
+		size_t rank = (size_t)ceil(p * times.size());
+		return times[std::max(rank, (size_t)1) - 1];
+	};
+	double mean = total / times.size();
+	double p50 = percentile(0.50);
+	double p99 = percentile(0.99);
+	// Each iteration plays every frame of the dump, so report draws and verts for a whole pass.
+	iterations = std::max(iterations, 1);
+	int drawCalls = (int)(totalDraws / iterations);
+	int vertices = (int)(totalVerts / iterations);
+
+	printf("%s: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, min %.3f ms, %d draws, %d verts per iteration\n", filename.c_str(), mean, p50, p99, times.front(), drawCalls, vertices);
+
+	writer.pushDict();
+	writer.writeString("file", filename);
+	writer.writeInt("frames", (int)frames.size());
+	writer.writeFloat("meanMs", mean);
+	writer.writeFloat("p50Ms", p50);
+	writer.writeFloat("p99Ms", p99);
+	writer.writeFloat("minMs", times.front());
+	writer.writeFloat("maxMs", times.back());
+	writer.writeInt("drawCalls", drawCalls);
+	writer.writeInt("vertices", vertices);
+	writer.writeString("backendStats", backendStats);
+	writer.pop();
+}
+
+bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout, bool syscallStats, const char *syscallTraceFilename)
 {
 	// Kinda ugly, trying to guesstimate the test name from filename...
 	currentTestName = GetTestName(coreParameter.fileToStart);
@@ -209,6 +307,7 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 		if (coreState == CORE_NEXTFRAME) {
 			coreState = CORE_RUNNING;
 			headlessHost->SwapBuffers();
+			PROFILE_END_FRAME();
 		}
 		if (coreState == CORE_STEPPING && !coreParameter.startBreak) {
 			break;
@@ -229,6 +328,18 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 	if (coreParameter.graphicsContext && coreParameter.graphicsContext->GetDrawContext())
 		coreParameter.graphicsContext->GetDrawContext()->EndFrame();
 
+	if (syscallStats) {
+		PrintSyscallStats();
+		hleResetSyscallStats();
+	}
+	if (syscallTraceFilename) {
+		int records = hleDumpSyscallTrace(Path(std::string(syscallTraceFilename)));
+		if (records < 0)
+			fprintf(stderr, "Failed to write syscall trace to %s\n", syscallTraceFilename);
+		// Each test's dump should only contain its own syscalls.
+		hleClearSyscallTrace();
+	}
+
 	PSP_Shutdown();
 
 	headlessHost->FlushDebugOutput();
@@ -265,6 +376,12 @@ int main(int argc, const char* argv[])
 	const char *mountRoot = nullptr;
 	const char *screenshotFilename = nullptr;
 	float timeout = std::numeric_limits<float>::infinity();
+	bool syscallStats = false;
+	const char *syscallTraceFilename = nullptr;
+	const char *profileTraceFilename = nullptr;
+	int benchIterations = 0;
+	const char *benchOutputFilename = nullptr;
+	bool flatRaster = false;
 
 	for (int i = 1; i < argc; i++)
 	{
@@ -322,6 +439,20 @@ int main(int argc, const char* argv[])
 			timeout = (float)strtod(argv[i] + strlen("--timeout="), NULL);
 		else if (!strncmp(argv[i], "--debugger=", strlen("--debugger=")) && strlen(argv[i]) > strlen("--debugger="))
 			debuggerPort = (int)strtoul(argv[i] + strlen("--debugger="), NULL, 10);
+		else if (!strcmp(argv[i], "--syscall-stats"))
+			syscallStats = true;
+		else if (!strncmp(argv[i], "--syscall-trace=", strlen("--syscall-trace=")) && strlen(argv[i]) > strlen("--syscall-trace="))
+			syscallTraceFilename = argv[i] + strlen("--syscall-trace=");
+		else if (!strncmp(argv[i], "--profile-trace=", strlen("--profile-trace=")) && strlen(argv[i]) > strlen("--profile-trace="))
+			profileTraceFilename = argv[i] + strlen("--profile-trace=");
+		else if (!strncmp(argv[i], "--bench=", strlen("--bench=")) && strlen(argv[i]) > strlen("--bench="))
+			benchIterations = std::max(1, atoi(argv[i] + strlen("--bench=")));
+		else if (!strncmp(argv[i], "--bench-output=", strlen("--bench-output=")) && strlen(argv[i]) > strlen("--bench-output="))
+			benchOutputFilename = argv[i] + strlen("--bench-output=");
+		else if (!strcmp(argv[i], "--shared-disk-cache"))
+			DiskCachingFileLoaderCache::SetShared(true);
+		else if (!strcmp(argv[i], "--flat-raster"))
+			flatRaster = true;
 		else if (!strcmp(argv[i], "--teamcity"))
 			teamCityMode = true;
 		else if (!strncmp(argv[i], "--state=", strlen("--state=")) && strlen(argv[i]) > strlen("--state="))
@@ -343,6 +474,9 @@ int main(int argc, const char* argv[])
 			testFilenames.push_back(temp);
 	}
 
+	if (benchIterations > 0)
+		testFilenames = ExpandBenchmarkDumps(testFilenames);
+
 	if (testFilenames.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
 
@@ -410,6 +544,7 @@ int main(int argc, const char* argv[])
 	g_Config.bSoftwareSkinning = true;
 	g_Config.bVertexDecoderJit = true;
 	g_Config.bSoftwareRenderingJit = true;
+	g_Config.bSoftwareRenderingHierarchical = !flatRaster;
 	g_Config.bBlockTransferGPU = true;
 	g_Config.iSplineBezierQuality = 2;
 	g_Config.bHighQualityDepth = true;
@@ -470,6 +605,18 @@ int main(int argc, const char* argv[])
 	if (stateToLoad != NULL)
 		SaveState::Load(Path(stateToLoad), -1);
 
+	if (syscallStats || syscallTraceFilename)
+		hleSetSyscallTrace(true, syscallTraceFilename ? 1024 * 1024 : 0);
+	if (profileTraceFilename)
+		Profiler_SetTracing(true);
+
+	json::JsonWriter benchWriter(json::JsonWriter::PRETTY);
+	if (benchIterations > 0) {
+		benchWriter.begin();
+		benchWriter.writeInt("iterations", benchIterations);
+		benchWriter.pushArray("dumps");
+	}
+
 	std::vector<std::string> failedTests;
 	std::vector<std::string> passedTests;
 	for (size_t i = 0; i < testFilenames.size(); ++i)
@@ -477,7 +624,11 @@ int main(int argc, const char* argv[])
 		coreParameter.fileToStart = Path(testFilenames[i]);
 		if (autoCompare)
 			printf("%s:\n", coreParameter.fileToStart.c_str());
-		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout);
+		if (benchIterations > 0)
+			GPURecord::SetReplayBenchmark(benchIterations);
+		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout, syscallStats, syscallTraceFilename);
+		if (benchIterations > 0)
+			ReportBenchmark(benchWriter, testFilenames[i], benchIterations);
 		if (autoCompare)
 		{
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -503,6 +654,17 @@ int main(int argc, const char* argv[])
 		}
 	}
 
+	if (benchIterations > 0) {
+		GPURecord::SetReplayBenchmark(0);
+		benchWriter.pop();
+		benchWriter.end();
+		if (benchOutputFilename && !File::WriteStringToFile(true, benchWriter.str(), Path(std::string(benchOutputFilename))))
+			fprintf(stderr, "Failed to write benchmark results to %s\n", benchOutputFilename);
+	}
+
+	if (profileTraceFilename && !Profiler_SaveTrace(Path(std::string(profileTraceFilename))))
+		fprintf(stderr, "Failed to write profile trace to %s\n", profileTraceFilename);
+
 	if (debuggerPort > 0) {
 		ShutdownWebServer();
 	}
@@ -18,7 +18,9 @@
 #include "Common/Data/Random/Rng.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
+#include "GPU/Software/BinManager.h"
 #include "GPU/Software/DrawPixel.h"
+#include "GPU/Software/Rasterizer.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
 
@@ -154,6 +156,125 @@ static bool TestPixelJit() {
 	return successes == count && !HitAnyAsserts();
 }
 
+struct RasterPixel {
+	u32 color;
+	u16 depth;
+	u8 fog;
+	u8 hits;
+};
+
+static RasterPixel *rasterTarget;
+
+static void SOFTRAST_CALL RecordRasterPixel(int x, int y, int z, int fog, Rasterizer::Vec4IntArg color_in, const PixelFuncID &pixelID) {
+	if (x < 0 || x >= 512 || y < 0 || y >= 512)
+		return;
+	RasterPixel &px = rasterTarget[y * 512 + x];
+	px.color = Vec4<int>(color_in).Clamp(0, 255).ToRGBA();
+	px.depth = (u16)z;
+	px.fog = (u8)fog;
+	px.hits++;
+}
+
+// The tiled triangle walk must produce exactly the same pixels as the flat one.
+static bool TestTriangleTiles() {
+	using namespace Rasterizer;
+
+	RasterizerState state{};
+	memset(&state.pixelID, 0, sizeof(state.pixelID));
+	state.pixelID.applyFog = true;
+	state.drawPixel = &RecordRasterPixel;
+	state.shadeGouraud = true;
+
+	RasterPixel *flat = new RasterPixel[512 * 512];
+	RasterPixel *tiled = new RasterPixel[512 * 512];
+	memset(flat, 0, sizeof(RasterPixel) * 512 * 512);
+	memset(tiled, 0, sizeof(RasterPixel) * 512 * 512);
+
+	GMRng rng;
+	int count = 1000;
+	int failures = 0;
+	for (int i = 0; i < count; ++i) {
+		// Mix small and screen sized triangles, and some too large for the tiled path.
+		int spread = i % 3 == 0 ? 64 * 16 : (i % 3 == 1 ? 512 * 16 : 8192 * 16);
+		int originX = (int)(rng.R32() % (512 * 16));
+		int originY = (int)(rng.R32() % (512 * 16));
+
+		// Snapping to whole pixels puts pixels exactly on edges, which tests the fill rule.
+		int snap = i & 4 ? ~0xF : ~0;
+
+		VertexData v[3];
+		for (int j = 0; j < 3; ++j) {
+			int x = originX + (int)(rng.R32() % spread) - spread / 2;
+			int y = originY + (int)(rng.R32() % spread) - spread / 2;
+			v[j].screenpos = ScreenCoords(x & snap, y & snap, (u16)rng.R32());
+			v[j].color0 = Vec4<int>(rng.R32() & 0xFF, rng.R32() & 0xFF, rng.R32() & 0xFF, rng.R32() & 0xFF);
+			v[j].color1 = Vec3<int>(rng.R32() & 0x3F, rng.R32() & 0x3F, rng.R32() & 0x3F);
+			v[j].fogdepth = rng.F();
+		}
+		// Axis aligned edges can run right along a tile's first pixels.
+		if (i & 8) {
+			v[1].screenpos.x = v[0].screenpos.x;
+			v[2].screenpos.y = v[0].screenpos.y;
+		}
+
+		BinCoords range;
+		range.x1 = std::min(std::min(v[0].screenpos.x, v[1].screenpos.x), v[2].screenpos.x) & ~0xF;
+		range.y1 = std::min(std::min(v[0].screenpos.y, v[1].screenpos.y), v[2].screenpos.y) & ~0xF;
+		range.x2 = std::max(std::max(v[0].screenpos.x, v[1].screenpos.x), v[2].screenpos.x) | 0xF;
+		range.y2 = std::max(std::max(v[0].screenpos.y, v[1].screenpos.y), v[2].screenpos.y) | 0xF;
+		range.x1 = std::max(range.x1, 0);
+		range.y1 = std::max(range.y1, 0);
+		range.x2 = std::min(range.x2, 512 * 16 - 1);
+		range.y2 = std::min(range.y2, 512 * 16 - 1);
+		if (range.Invalid())
+			continue;
+
+		// Nothing outside the range is drawn, so only that part needs clearing and comparing.
+		const int rowStart = range.y1 / 16 * 512 + range.x1 / 16;
+		const int rowBytes = (range.x2 / 16 - range.x1 / 16 + 1) * (int)sizeof(RasterPixel);
+		const int rows = range.y2 / 16 - range.y1 / 16 + 1;
+		auto clearRange = [&](RasterPixel *target) {
+			for (int y = 0; y < rows; ++y)
+				memset(target + rowStart + y * 512, 0, rowBytes);
+		};
+		auto rangeMatches = [&]() {
+			for (int y = 0; y < rows; ++y) {
+				if (memcmp(flat + rowStart + y * 512, tiled + rowStart + y * 512, rowBytes) != 0)
+					return false;
+			}
+			return true;
+		};
+
+		// One of the two windings is culled, but both should agree on that too.
+		for (int winding = 0; winding < 2; ++winding) {
+			const VertexData &v1 = winding == 0 ? v[1] : v[2];
+			const VertexData &v2 = winding == 0 ? v[2] : v[1];
+
+			clearRange(flat);
+			rasterTarget = flat;
+			state.hierarchicalRaster = false;
+			DrawTriangle(v[0], v1, v2, range, state);
+
+			clearRange(tiled);
+			rasterTarget = tiled;
+			state.hierarchicalRaster = true;
+			DrawTriangle(v[0], v1, v2, range, state);
+
+			if (!rangeMatches()) {
+				if (failures == 0)
+					printf("Tiled triangles differ from flat:\n");
+				failures++;
+				printf(" * %d,%d %d,%d %d,%d\n", v[0].screenpos.x, v[0].screenpos.y, v1.screenpos.x, v1.screenpos.y, v2.screenpos.x, v2.screenpos.y);
+			}
+		}
+	}
+
+	delete [] flat;
+	delete [] tiled;
+	rasterTarget = nullptr;
+	return failures == 0;
+}
+
 bool TestSoftwareGPUJit() {
 	g_Config.bSoftwareRenderingJit = true;
 	ResetHitAnyAsserts();
@@ -166,5 +287,9 @@ bool TestSoftwareGPUJit() {
 		return false;
 	}
 
+	if (!TestTriangleTiles()) {
+		return false;
+	}
+
 	return true;
 }
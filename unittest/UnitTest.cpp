@@ -29,9 +29,13 @@
 
 #include "ppsspp_config.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -54,11 +58,14 @@
 #include "Common/BitScan.h"
 #include "Common/CPUDetect.h"
 #include "Common/Log.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/FileSystems/ISOFileSystem.h"
+#include "Core/HW/MediaEngine.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 #include "GPU/Common/TextureDecoder.h"
+#include "GPU/Math3D.h"
 
 #include "android/jni/AndroidContentURI.h"
 
@@ -370,6 +377,50 @@ bool TestMatrixTranspose() {
 	return true;
 }
 
+static bool TestMatrixBatch() {
+#ifdef MATH3D_HAS_X4
+	// The batch versions must give exactly the same bits, or software transform would change results.
+	float m43[12];
+	float m44[16];
+	for (int i = 0; i < 16; ++i) {
+		if (i < 12)
+			m43[i] = (float)(rand() - RAND_MAX / 2) / 1024.0f;
+		m44[i] = (float)(rand() - RAND_MAX / 2) / 8192.0f;
+	}
+
+	for (int iter = 0; iter < 1000; ++iter) {
+		float pos[4][4]{};
+		for (int v = 0; v < 4; ++v) {
+			for (int c = 0; c < 3; ++c)
+				pos[v][c] = (float)(rand() - RAND_MAX / 2) / 65536.0f;
+		}
+
+		Vec4Lanes in[4];
+		Load4x4Transposed(in, pos[0], pos[1], pos[2], pos[3]);
+		Vec4Lanes out43[3];
+		Vec3ByMatrix43x4(out43, in[0], in[1], in[2], m43);
+		Vec4Lanes out44[4];
+		Vec3ByMatrix44x4(out44, in[0], in[1], in[2], m44);
+
+		float batch43[4][4];
+		Vec4Lanes out43Padded[4] = { out43[0], out43[1], out43[2], out43[2] };
+		Store4x4Transposed(batch43[0], batch43[1], batch43[2], batch43[3], out43Padded);
+		float batch44[4][4];
+		Store4x4Transposed(batch44[0], batch44[1], batch44[2], batch44[3], out44);
+
+		for (int v = 0; v < 4; ++v) {
+			float single43[3];
+			Vec3ByMatrix43(single43, pos[v], m43);
+			float single44[4];
+			Vec3ByMatrix44(single44, pos[v], m44);
+			EXPECT_TRUE(memcmp(single43, batch43[v], sizeof(single43)) == 0);
+			EXPECT_TRUE(memcmp(single44, batch44[v], sizeof(single44)) == 0);
+		}
+	}
+#endif
+	return true;
+}
+
 void TestGetMatrix(int matrix, MatrixSize sz) {
 	INFO_LOG(SYSTEM, "Testing matrix %s", GetMatrixNotation(matrix, sz));
 	u8 fullMatrix[16];
@@ -509,6 +560,94 @@ bool TestQuickTexHash() {
 	return true;
 }
 
+// Times a decode kernel over a buffer, for comparing vectorized kernels to the scalar reference.
+template <typename F>
+static double BenchTextureKernel(F func) {
+	int count = 0;
+	double st = time_now_d();
+	do {
+		func();
+		++count;
+	} while (time_now_d() - st < 0.1);
+	return count / (time_now_d() - st);
+}
+
+static bool TestTextureDecoders() {
+	SetupTextureDecoder();
+
+	static const int PIXELS = 512;
+	u8 indexed[PIXELS];
+	for (int i = 0; i < PIXELS; ++i)
+		indexed[i] = rand() & 0xFF;
+	u32 clut32[256];
+	u16 clut16[256];
+	for (int i = 0; i < 256; ++i) {
+		clut32[i] = (u32)rand() ^ ((u32)rand() << 16);
+		clut16[i] = (u16)rand();
+	}
+
+	std::vector<u32> ref32(PIXELS), out32(PIXELS);
+	std::vector<u16> ref16(PIXELS), out16(PIXELS);
+	// Lengths that are not a multiple of 16 exercise the scalar tails.
+	static const int lengths[] = { 2, 14, 16, 30, 64, 250, PIXELS };
+	for (int length : lengths) {
+		DeIndexTexture4Simple16Basic(ref16.data(), indexed, length, clut16);
+		DeIndexTexture4Simple16(out16.data(), indexed, length, clut16);
+		EXPECT_TRUE(memcmp(ref16.data(), out16.data(), length * sizeof(u16)) == 0);
+		DeIndexTexture4Simple32Basic(ref32.data(), indexed, length, clut32);
+		DeIndexTexture4Simple32(out32.data(), indexed, length, clut32);
+		EXPECT_TRUE(memcmp(ref32.data(), out32.data(), length * sizeof(u32)) == 0);
+		DeIndexTexture8Simple32Basic(ref32.data(), indexed, length, clut32);
+		DeIndexTexture8Simple32(out32.data(), indexed, length, clut32);
+		EXPECT_TRUE(memcmp(ref32.data(), out32.data(), length * sizeof(u32)) == 0);
+	}
+
+	// 16x16 pixels of DXT blocks, in a pitch of 16.  Random data covers both color modes.
+	static const int BLOCKS = 16;
+	DXT5Block blocks[BLOCKS];
+	for (int i = 0; i < BLOCKS; ++i) {
+		u8 *p = (u8 *)&blocks[i];
+		for (size_t j = 0; j < sizeof(DXT5Block); ++j)
+			p[j] = rand() & 0xFF;
+	}
+	auto decodeDXT = [&](std::vector<u32> &out, bool basic, int n) {
+		for (int i = 0; i < BLOCKS; ++i) {
+			u32 *dst = out.data() + (i / 4) * 64 + (i % 4) * 4;
+			// Use a short last row of blocks to check partial heights.
+			int height = i >= 12 ? 3 : 4;
+			if (n == 1)
+				(basic ? DecodeDXT1BlockBasic : DecodeDXT1Block)(dst, &blocks[i].color, 16, height, (i & 1) != 0);
+			else if (n == 3)
+				(basic ? DecodeDXT3BlockBasic : DecodeDXT3Block)(dst, (const DXT3Block *)&blocks[i], 16, height);
+			else
+				(basic ? DecodeDXT5BlockBasic : DecodeDXT5Block)(dst, &blocks[i], 16, height);
+		}
+	};
+	for (int n : { 1, 3, 5 }) {
+		std::fill(ref32.begin(), ref32.end(), 0);
+		std::fill(out32.begin(), out32.end(), 0);
+		decodeDXT(ref32, true, n);
+		decodeDXT(out32, false, n);
+		EXPECT_TRUE(ref32 == out32);
+	}
+
+	// Not pass/fail, but useful to see whether the vectorized kernels are worth it on this CPU.
+	auto report = [](const char *name, double basic, double selected) {
+		printf("%s: %.2fx vs scalar\n", name, selected / basic);
+	};
+	report("CLUT4 16-bit", BenchTextureKernel([&] { DeIndexTexture4Simple16Basic(out16.data(), indexed, PIXELS, clut16); }),
+		BenchTextureKernel([&] { DeIndexTexture4Simple16(out16.data(), indexed, PIXELS, clut16); }));
+	report("CLUT4 32-bit", BenchTextureKernel([&] { DeIndexTexture4Simple32Basic(out32.data(), indexed, PIXELS, clut32); }),
+		BenchTextureKernel([&] { DeIndexTexture4Simple32(out32.data(), indexed, PIXELS, clut32); }));
+	report("CLUT8 32-bit", BenchTextureKernel([&] { DeIndexTexture8Simple32Basic(out32.data(), indexed, PIXELS, clut32); }),
+		BenchTextureKernel([&] { DeIndexTexture8Simple32(out32.data(), indexed, PIXELS, clut32); }));
+	report("DXT1", BenchTextureKernel([&] { decodeDXT(out32, true, 1); }), BenchTextureKernel([&] { decodeDXT(out32, false, 1); }));
+	report("DXT3", BenchTextureKernel([&] { decodeDXT(out32, true, 3); }), BenchTextureKernel([&] { decodeDXT(out32, false, 3); }));
+	report("DXT5", BenchTextureKernel([&] { decodeDXT(out32, true, 5); }), BenchTextureKernel([&] { decodeDXT(out32, false, 5); }));
+
+	return true;
+}
+
 bool TestCLZ() {
 	static const uint32_t input[] = {
 		0xFFFFFFFF,
@@ -741,6 +880,73 @@ static bool TestWrapText() {
 	return true;
 }
 
+// Plays the decode-ahead worker against a game that feeds stream data slowly and is slow to wake.
+static bool TestMediaAheadRead() {
+	const int FRAMES = 20;
+	const int FRAME_BYTES = 4;
+
+	std::mutex lock;
+	std::condition_variable cond;
+	int fedBytes = 0;
+	int cursor = 0;
+	int framesReady = 0;
+	bool demand = false;
+	bool stop = false;
+	int framesDecoded = 0;
+	bool endedEarly = false;
+
+	std::thread worker([&] {
+		std::unique_lock<std::mutex> guard(lock);
+		while (!stop && framesDecoded < FRAMES) {
+			// Like readAheadData(), one byte at a time.
+			for (int i = 0; i < FRAME_BYTES; ++i) {
+				cond.wait(guard, [&] { return MediaAheadCanRead(stop, demand, framesReady, fedBytes, cursor); });
+				if (fedBytes <= cursor) {
+					endedEarly = !stop;
+					cond.notify_all();
+					return;
+				}
+				cursor++;
+			}
+			framesDecoded++;
+			framesReady++;
+			cond.notify_all();
+		}
+	});
+
+	for (int frame = 0; frame < FRAMES; ++frame) {
+		// The game only asks for a frame once its data is there, but adds the next one slowly.
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			fedBytes += FRAME_BYTES;
+			cond.notify_all();
+		}
+		std::unique_lock<std::mutex> guard(lock);
+		demand = true;
+		cond.notify_all();
+		cond.wait(guard, [&] { return framesReady > 0 || endedEarly; });
+		if (endedEarly)
+			break;
+		guard.unlock();
+		sleep_ms(1);
+		guard.lock();
+		demand = false;
+		framesReady--;
+		cond.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stop = true;
+		cond.notify_all();
+	}
+	worker.join();
+
+	EXPECT_FALSE(endedEarly);
+	EXPECT_EQ_INT(framesDecoded, FRAMES);
+	return true;
+}
+
 typedef bool (*TestFunc)();
 struct TestItem {
 	const char *name;
@@ -774,8 +980,10 @@ TestItem availableTests[] = {
 	TEST_ITEM(Parsers),
 	TEST_ITEM(Jit),
 	TEST_ITEM(MatrixTranspose),
+	TEST_ITEM(MatrixBatch),
 	TEST_ITEM(ParseLBN),
 	TEST_ITEM(QuickTexHash),
+	TEST_ITEM(TextureDecoders),
 	TEST_ITEM(CLZ),
 	TEST_ITEM(MemMap),
 	TEST_ITEM(ShaderGenerators),
@@ -784,6 +992,7 @@ TestItem availableTests[] = {
 	TEST_ITEM(AndroidContentURI),
 	TEST_ITEM(ThreadManager),
 	TEST_ITEM(WrapText),
+	TEST_ITEM(MediaAheadRead),
 };
 
 int main(int argc, const char *argv[]) {